@@ -0,0 +1,169 @@
+// SmoothScopeAnalyze: builds a SmoothScope level history from an audio file,
+// faster than realtime.
+//
+// Build with -DSMOOTHSCOPE_BUILD_ANALYZE=ON and run
+//   SmoothScopeAnalyze <input audio file> [-o output.ssx] [--hop seconds]
+//
+// The file is split into chunks of whole hops. Each chunk gets its own reader,
+// is read in large blocks and measured by the plugin's LevelAnalyser, with the
+// chunks spread over the shared RenderWorkerPool, so a run is bound by disk
+// bandwidth rather than by a host's callback rate. Because chunks start on hop
+// boundaries, the frames are exactly the ones the plugin would have recorded.
+// The result is HistoryExporter's .ssx format, which the editor imports with 'O'.
+
+#include <JuceHeader.h>
+
+#include "LevelAnalyser.h"
+#include "HistoryExporter.h"
+#include "RenderWorkerPool.h"
+
+namespace
+{
+    constexpr int hopsPerChunk = 4096;         // ~41 s per task at the 10 ms hop
+    constexpr int readBlockSamples = 1 << 16;  // per reader call
+
+    struct Job
+    {
+        juce::File input;
+        double sampleRate = 0.0;
+        double hopSeconds = LevelAnalyser::defaultHopSeconds;
+        int hopSize = 0;
+        int numChannels = 0;
+        juce::int64 numFrames = 0;
+
+        std::vector<float> rms, peak;
+        std::atomic<bool> failed { false };
+    };
+
+    void analyseChunk (Job& job, juce::AudioFormatManager& formats, int chunk)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (job.input));
+
+        if (reader == nullptr)
+        {
+            job.failed = true;
+            return;
+        }
+
+        const auto firstFrame = (juce::int64) chunk * hopsPerChunk;
+        const auto endFrame = juce::jmin (job.numFrames, firstFrame + hopsPerChunk);
+
+        LevelAnalyser analyser;
+        analyser.prepare (job.sampleRate, job.hopSeconds);
+
+        juce::AudioBuffer<float> buffer (job.numChannels, readBlockSamples);
+        auto frame = (size_t) firstFrame;
+
+        for (auto pos = firstFrame * job.hopSize, end = endFrame * job.hopSize; pos < end;)
+        {
+            const int numSamples = (int) juce::jmin ((juce::int64) readBlockSamples, end - pos);
+
+            if (! reader->read (&buffer, 0, numSamples, pos, true, true))
+            {
+                job.failed = true;
+                return;
+            }
+
+            analyser.process (buffer.getArrayOfReadPointers(), job.numChannels, numSamples,
+                              [&] (const LevelFrame& f)
+                              {
+                                  job.rms[frame] = f.rms;
+                                  job.peak[frame] = f.peak;
+                                  ++frame;
+                              });
+
+            pos += numSamples;
+        }
+    }
+
+    int fail (const juce::String& message)
+    {
+        std::cerr << message << std::endl;
+        return 1;
+    }
+}
+
+int main (int argc, char** argv)
+{
+    const juce::ArgumentList args (argc, argv);
+
+    if (args.size() < 1 || args.containsOption ("--help|-h"))
+    {
+        std::cout << "Usage: SmoothScopeAnalyze <input audio file> [-o output.ssx] [--hop seconds]" << std::endl;
+        return args.size() < 1 ? 1 : 0;
+    }
+
+    Job job;
+    job.input = args[0].resolveAsFile();
+
+    if (args.containsOption ("--hop"))
+        job.hopSeconds = args.getValueForOption ("--hop").getDoubleValue();
+
+    if (job.hopSeconds <= 0.0)
+        return fail ("--hop must be positive");
+
+    const auto output = args.containsOption ("-o") ? args.getFileForOption ("-o")
+                                                   : job.input.withFileExtension ("ssx");
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (job.input));
+
+        if (reader == nullptr)
+            return fail ("Cannot read " + job.input.getFullPathName());
+
+        job.sampleRate = reader->sampleRate;
+        job.numChannels = juce::jmin ((int) reader->numChannels, LevelFrame::maxChannels);
+
+        LevelAnalyser probe;
+        probe.prepare (job.sampleRate, job.hopSeconds);
+        job.hopSize = probe.getHopSize();
+
+        // Only complete hops, like the live analysis
+        job.numFrames = reader->lengthInSamples / job.hopSize;
+    }
+
+    if (job.numFrames == 0)
+        return fail ("Nothing to analyse");
+
+    job.rms.resize ((size_t) job.numFrames);
+    job.peak.resize ((size_t) job.numFrames);
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const int numChunks = (int) ((job.numFrames + hopsPerChunk - 1) / hopsPerChunk);
+
+    juce::SharedResourcePointer<RenderWorkerPool> pool;
+    pool->parallelFor (numChunks, [&] (int chunk) { analyseChunk (job, formats, chunk); });
+
+    if (job.failed)
+        return fail ("Reading " + job.input.getFullPathName() + " failed");
+
+    const auto frameRate = job.sampleRate / (double) job.hopSize;
+    juce::TemporaryFile temp (output);
+
+    {
+        juce::FileOutputStream out (temp.getFile(), 1 << 20);
+
+        if (! out.openedOk())
+            return fail ("Cannot create " + temp.getFile().getFullPathName());
+
+        const auto result = HistoryExporter::writeBinary (out, job.rms.data(), job.peak.data(), job.numFrames, 0, frameRate);
+        out.flush();
+
+        if (result.failed() || out.getStatus().failed())
+            return fail ("Writing " + output.getFullPathName() + " failed");
+    }
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return fail ("Cannot write " + output.getFullPathName());
+
+    const auto seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    const auto audioSeconds = (double) job.numFrames * (double) job.hopSize / job.sampleRate;
+
+    std::cout << job.numFrames << " frames (" << audioSeconds << " s of audio) in " << seconds << " s, "
+              << audioSeconds / juce::jmax (seconds, 1.0e-6) << "x realtime, on "
+              << pool->getNumWorkers() + 1 << " threads -> " << output.getFullPathName() << std::endl;
+    return 0;
+}
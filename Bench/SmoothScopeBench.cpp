@@ -0,0 +1,215 @@
+// SmoothScopeBench: micro-benchmarks of the processor and editor hot paths.
+//
+// Build with -DSMOOTHSCOPE_BUILD_BENCH=ON and run e.g.
+//   SmoothScopeBench --benchmark_format=json --benchmark_out=results.json
+// to get machine-readable results that can be diffed between builds.
+
+#include <JuceHeader.h>
+#include <benchmark/benchmark.h>
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+namespace
+{
+    // Deterministic white noise at -6 dBFS
+    void fillSignal (juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.5f;
+        }
+    }
+
+    // Synthetic level history with a slow modulation, so it has structure at every zoom level
+    std::vector<float> makeLevels (juce::int64 numFrames, float scale)
+    {
+        std::vector<float> levels ((size_t) numFrames);
+        juce::Random random (42);
+
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            const auto slow = 0.5f + 0.4f * std::sin ((float) i * 0.0007f);
+            levels[i] = scale * slow * (0.8f + 0.2f * random.nextFloat());
+        }
+
+        return levels;
+    }
+
+    std::unique_ptr<SmoothScopeAudioProcessor> makeProcessor (int numChannels, int blockSize)
+    {
+        auto processor = std::make_unique<SmoothScopeAudioProcessor>();
+
+        const auto layoutSet = numChannels == 1 ? juce::AudioChannelSet::mono()
+                             : numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                                : juce::AudioChannelSet::discreteChannels (numChannels);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (layoutSet);
+        layout.outputBuses.add (layoutSet);
+        processor->setBusesLayout (layout);
+
+        processor->setRateAndBufferSizeDetails (48000.0, blockSize);
+        processor->prepareToPlay (48000.0, blockSize);
+        return processor;
+    }
+}
+
+// --- Processor ---
+// Per-sample cost of processBlock (analysis + FIFO push); the history thread drains concurrently.
+// truePeak = 1 adds the 4x oversampled true-peak detector, loudness = 1 the K-weighting filter.
+static void BM_ProcessBlock (benchmark::State& state)
+{
+    const auto blockSize = (int) state.range (0);
+    const auto numChannels = (int) state.range (1);
+
+    auto processor = makeProcessor (numChannels, blockSize);
+    processor->setTruePeakEnabled (state.range (2) != 0);
+    processor->setLoudnessEnabled (state.range (3) != 0);
+
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+    juce::Random random (1);
+    fillSignal (buffer, random);
+    juce::MidiBuffer midi;
+
+    for (auto _ : state)
+    {
+        processor->processBlock (buffer, midi);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed (state.iterations() * blockSize * numChannels);
+    state.counters["samples/s"] = benchmark::Counter ((double) state.iterations() * blockSize, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK (BM_ProcessBlock)
+    ->ArgNames ({ "block", "channels", "truePeak", "loudness" })
+    ->ArgsProduct ({ { 32, 128, 512, 2048 }, { 1, 2, 8, 16 }, { 0, 1 }, { 0, 1 } });
+
+// --- FIFO ---
+// Frames through the SPSC ring, pushed one by one and drained in bulk like the history thread does.
+static void BM_FifoThroughput (benchmark::State& state)
+{
+    SpscRing<LevelFrame, SmoothScopeAudioProcessor::fifoSize> fifo;
+    LevelFrame frame {};
+    frame.numChannels = 2;
+
+    const auto batch = (int) state.range (0);
+    float sink = 0.0f;
+
+    for (auto _ : state)
+    {
+        for (int i = 0; i < batch; ++i)
+            fifo.push (frame);
+
+        auto spans = fifo.prepareRead();
+        spans.forEach ([&sink] (const LevelFrame& f) { sink += f.rms; });
+        fifo.commitRead (spans.getTotalSize());
+    }
+
+    benchmark::DoNotOptimize (sink);
+    state.SetItemsProcessed (state.iterations() * batch);
+}
+
+BENCHMARK (BM_FifoThroughput)->ArgName ("batch")->Arg (1)->Arg (16)->Arg (256)->Arg (1000);
+
+// --- History drain ---
+// The per-frame work of the history thread: RMS + peak pyramids plus per-channel lanes.
+static void BM_HistoryDrain (benchmark::State& state)
+{
+    const auto numChannels = (int) state.range (0);
+
+    HistoryStore::Pyramid rms (HistoryStore::historySize), peak (HistoryStore::historySize);
+    std::vector<std::unique_ptr<MinMaxPyramid<LogLevelCodec16>>> lanes;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        lanes.push_back (std::make_unique<MinMaxPyramid<LogLevelCodec16>> (HistoryStore::historySize));
+
+    const auto levels = makeLevels (65536, 1.0f);
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        const float v = levels[i++ & 65535];
+        rms.push (v);
+        peak.push (v * 1.4f);
+
+        for (auto& lane : lanes)
+            lane->push (v);
+    }
+
+    state.SetItemsProcessed (state.iterations());
+}
+
+BENCHMARK (BM_HistoryDrain)->ArgName ("channels")->Arg (0)->Arg (2)->Arg (16);
+
+// --- History rebuild ---
+// Full parallel pyramid rebuild, as after restoring a session.
+static void BM_HistoryRestore (benchmark::State& state)
+{
+    auto processor = makeProcessor (2, 512);
+    const auto numFrames = (juce::int64) state.range (0);
+    const auto rms = makeLevels (numFrames, 1.0f);
+    const auto peak = makeLevels (numFrames, 1.4f);
+
+    for (auto _ : state)
+        processor->getHistoryStore().restore (rms.data(), peak.data(), numFrames);
+
+    state.SetItemsProcessed (state.iterations() * numFrames);
+}
+
+BENCHMARK (BM_HistoryRestore)->ArgName ("frames")->Arg (65536)->Arg (HistoryStore::historySize)->Arg (4 * HistoryStore::historySize)
+    ->Unit (benchmark::kMillisecond);
+
+// --- Editor paint ---
+// Headless software paint into an Image across a zoom sweep that crosses all three zones.
+// Zoom is passed as 1e6 * zoomX, since benchmark arguments are integers.
+static void BM_Paint (benchmark::State& state)
+{
+    const auto width = (int) state.range (0);
+    const auto zoomX = (float) state.range (1) * 1.0e-6f;
+
+    auto processor = makeProcessor (2, 512);
+    const auto rms = makeLevels (HistoryStore::historySize, 1.0f);
+    const auto peak = makeLevels (HistoryStore::historySize, 1.4f);
+    processor->getHistoryStore().restore (rms.data(), peak.data(), HistoryStore::historySize);
+
+    SmoothScopeAudioProcessorEditor editor (*processor);
+    editor.setBackgroundRenderingEnabled (false); // measure the message-thread path itself
+    editor.setSize (width, 400);
+    editor.setZoom (zoomX, 1.0f);
+
+    juce::Image image (juce::Image::RGB, width, 400, true);
+
+    for (auto _ : state)
+    {
+        juce::Graphics g (image);
+        editor.paint (g);
+    }
+
+    state.counters["zoomX"] = zoomX;
+    state.counters["zone"] = zoomX >= LodPlanner::rawZoom ? 1 : (zoomX < LodPlanner::detailZoom ? 2 : 3);
+}
+
+BENCHMARK (BM_Paint)
+    ->ArgNames ({ "width", "zoomX_e6" })
+    ->ArgsProduct ({ { 400, 800, 1600 }, { 100, 2000, 20000, 100000, 500000, 2000000, 10000000 } })
+    ->Unit (benchmark::kMicrosecond);
+
+int main (int argc, char** argv)
+{
+    // The editor needs a message manager, even when painting offscreen
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    benchmark::Initialize (&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
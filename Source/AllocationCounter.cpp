@@ -0,0 +1,43 @@
+#include "AllocationCounter.h"
+
+#if SMOOTHSCOPE_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local juce::int64 threadAllocations = 0;
+
+    void* countedAllocate (std::size_t size)
+    {
+        ++threadAllocations;
+
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+}
+
+juce::int64 AllocationCounter::getThreadCount() noexcept { return threadAllocations; }
+
+// Only the plain forms are replaced; the aligned ones keep their default
+// implementation (and are not counted), which is fine for a debug aid.
+void* operator new (std::size_t size)                                    { return countedAllocate (size); }
+void* operator new[] (std::size_t size)                                  { return countedAllocate (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept    { try { return countedAllocate (size); } catch (...) { return nullptr; } }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept  { try { return countedAllocate (size); } catch (...) { return nullptr; } }
+
+void operator delete (void* p) noexcept                                  { std::free (p); }
+void operator delete[] (void* p) noexcept                                { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept                     { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept                   { std::free (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept           { std::free (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept         { std::free (p); }
+
+#else
+
+juce::int64 AllocationCounter::getThreadCount() noexcept { return 0; }
+
+#endif
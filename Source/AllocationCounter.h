@@ -0,0 +1,32 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SMOOTHSCOPE_COUNT_ALLOCATIONS
+ #define SMOOTHSCOPE_COUNT_ALLOCATIONS 0
+#endif
+
+// Debug aid for checking that hot paths (paint, GL geometry) stay off the heap.
+//
+// When SMOOTHSCOPE_COUNT_ALLOCATIONS is on, AllocationCounter.cpp replaces the
+// global operator new and counts every allocation per thread; a Scope reports
+// how many happened on its thread while it was alive. When it is off nothing
+// is replaced and every count reads zero.
+struct AllocationCounter
+{
+    static constexpr bool isEnabled = (SMOOTHSCOPE_COUNT_ALLOCATIONS != 0);
+
+    // Allocations made by the calling thread so far
+    static juce::int64 getThreadCount() noexcept;
+
+    class Scope
+    {
+    public:
+        Scope() noexcept : start (getThreadCount()) {}
+
+        juce::int64 getCount() const noexcept { return getThreadCount() - start; }
+
+    private:
+        const juce::int64 start;
+    };
+};
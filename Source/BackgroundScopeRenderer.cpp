@@ -0,0 +1,85 @@
+#include "BackgroundScopeRenderer.h"
+
+BackgroundScopeRenderer::BackgroundScopeRenderer (const HistoryStore& historyToUse)
+    : history (historyToUse)
+{
+}
+
+BackgroundScopeRenderer::~BackgroundScopeRenderer()
+{
+    pool->remove (*this);
+}
+
+void BackgroundScopeRenderer::request (const View& view)
+{
+    if (view == lastRequested || view.width <= 0 || view.height <= 0)
+        return;
+
+    lastRequested = view;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (pendingLock);
+        pendingView = view;
+        hasPending = true;
+    }
+
+    pool->schedule (*this);
+}
+
+bool BackgroundScopeRenderer::draw (juce::Graphics& g, int width, int height)
+{
+    frames.acquire();
+    const auto& frame = frames.getReadBuffer();
+
+    if (! frame.image.isValid())
+        return false;
+
+    // After a resize the previous frame is stretched until the new one arrives
+    g.drawImage (frame.image, 0, 0, width, height, 0, 0, frame.image.getWidth(), frame.image.getHeight());
+    return true;
+}
+
+void BackgroundScopeRenderer::renderPending()
+{
+    View view;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (pendingLock);
+
+        if (! hasPending)
+            return;
+
+        view = pendingView;
+        hasPending = false;
+    }
+
+    auto& frame = frames.getWriteBuffer();
+
+    const int imageW = juce::jmax (1, juce::roundToInt ((float) view.width * view.scale));
+    const int imageH = juce::jmax (1, juce::roundToInt ((float) view.height * view.scale));
+
+    if (! frame.image.isValid() || frame.image.getWidth() != imageW || frame.image.getHeight() != imageH)
+        frame.image = juce::Image (juce::Image::ARGB, imageW, imageH, true);
+    else
+        frame.image.clear (frame.image.getBounds());
+
+    const auto w = (float) view.width;
+    const auto plan = LodPlanner::plan ({ 0, 0, view.width, view.height }, view.width, view.zoomX);
+
+    {
+        // Frames arrive while the frame is rendered; stay on the position that was asked for
+        const juce::ScopedLock sl (history.getLock());
+        const auto framesAgo = juce::jmax ((juce::int64) 0, history.getPyramid().getNumWritten() - view.numWritten);
+        envelope.compute (history, plan.firstColumn, plan.endColumn, view.zoomX, framesAgo);
+    }
+
+    // Rasterise outside the history lock
+    juce::Graphics g (frame.image);
+    g.addTransform (juce::AffineTransform::scale (view.scale));
+
+    frame.numPoints = envelope.paint (g, ScopeMapping { (float) view.height, view.zoomY }, w, juce::Colours::cyan,
+                    plan.getMinThickness(), plan.getFillAlpha(), fillPath, peakPath);
+
+    frame.view = view;
+    frames.publish();
+}
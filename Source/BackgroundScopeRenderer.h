@@ -0,0 +1,76 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+#include "ColumnEnvelope.h"
+#include "LodPlanner.h"
+#include "RenderWorkerPool.h"
+#include "TripleBuffer.h"
+
+// Computes and rasterises the envelope zones (ZoomX < 1.0) on the shared
+// RenderWorkerPool, so the editor's paint() only has to blit the result.
+//
+// request() hands the current view to the pool; identical views are ignored
+// and a view that arrives mid-render is picked up right after it. Finished
+// frames travel back through a TripleBuffer, so neither side ever waits on
+// the other; the editor repaints once hasNewFrame() says one is ready.
+class BackgroundScopeRenderer : private RenderWorkerPool::Client
+{
+public:
+    struct View
+    {
+        int width = 0, height = 0;
+        float scale = 1.0f, zoomX = 1.0f, zoomY = 1.0f;
+        juce::int64 numWritten = -1; // the history position at the right edge of the frame
+
+        bool operator== (const View& other) const noexcept
+        {
+            return width == other.width && height == other.height && scale == other.scale
+                && zoomX == other.zoomX && zoomY == other.zoomY && numWritten == other.numWritten;
+        }
+
+        bool operator!= (const View& other) const noexcept { return ! operator== (other); }
+    };
+
+    explicit BackgroundScopeRenderer (const HistoryStore& historyToUse);
+    ~BackgroundScopeRenderer() override;
+
+    // --- Message thread ---
+    void request (const View& view);
+    bool hasNewFrame() const noexcept { return frames.hasNewData(); }
+
+    // Blits the newest finished frame into [0, width) x [0, height); false if there is none yet.
+    bool draw (juce::Graphics& g, int width, int height);
+
+    // Path points the worker emitted for the frame the last draw() blitted, for the diagnostics.
+    int getDrawnPoints() const noexcept { return frames.getReadBuffer().numPoints; }
+
+    // Drops the last requested view, so the next request() renders even if it is unchanged.
+    void invalidate() noexcept { lastRequested = {}; }
+
+private:
+    void renderPending() override;
+
+    struct Frame
+    {
+        juce::Image image; // transparent, drawn over the editor's background
+        View view;
+        int numPoints = 0;
+    };
+
+    const HistoryStore& history;
+    juce::SharedResourcePointer<RenderWorkerPool> pool;
+
+    juce::SpinLock pendingLock;
+    View pendingView;
+    bool hasPending = false;
+    View lastRequested; // message thread only
+
+    TripleBuffer<Frame> frames;
+
+    // Worker-side scratch, reused across frames
+    ColumnEnvelope envelope;
+    juce::Path fillPath, peakPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundScopeRenderer)
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Power-of-two circular history addressed by absolute (ever-increasing) index.
+//
+// Indexing is a single mask, with no branches or modulo, and any window of the
+// retained history can be fetched as at most two contiguous spans, so hot
+// loops can run over plain arrays without per-element wrap logic.
+//
+// The storage is one zero-initialised (calloc) block that nothing touches
+// ahead of the write head. Large blocks come straight from the OS as untouched
+// zero pages, so only the address space is reserved up front and memory is
+// committed page by page as history is recorded: an instance that has run for
+// a minute costs a minute's worth, not the full ring. Because of that, elements
+// start out as all-zero bits, which must read as silence for T.
+template <typename T>
+class CircularHistory
+{
+    static_assert (std::is_trivially_copyable<T>::value, "Elements are zero-filled and copied as raw memory");
+
+public:
+    // Chronological order: data1[0] is the oldest element of the window.
+    struct Spans
+    {
+        const T* data1 = nullptr;
+        int size1 = 0;
+        const T* data2 = nullptr;
+        int size2 = 0;
+
+        int getTotalSize() const noexcept { return size1 + size2; }
+    };
+
+    explicit CircularHistory (int capacityToUse)
+        : capacity (capacityToUse), mask ((juce::int64) capacityToUse - 1),
+          data ((size_t) capacityToUse, true)
+    {
+        jassert (juce::isPowerOfTwo (capacity));
+    }
+
+    void push (const T& value) noexcept           { data[(size_t) (numWritten++ & mask)] = value; }
+
+    // Zeroes only what has been written, so pages that were never touched stay uncommitted.
+    void clear() noexcept
+    {
+        std::memset (static_cast<void*> (data.get()), 0, (size_t) getNumAvailable() * sizeof (T));
+        numWritten = 0;
+    }
+
+    // Absolute index as counted by getNumWritten(); only meaningful inside [getOldest(), getNumWritten()).
+    const T& operator[] (juce::int64 absoluteIndex) const noexcept { return data[(size_t) (absoluteIndex & mask)]; }
+
+    // Bulk fill: write positions [0, n) through getFillPointer(), then call setNumWritten (n).
+    // Elements are contiguous from position 0, so disjoint ranges can be filled concurrently.
+    T* getFillPointer() noexcept                  { return data.get(); }
+    void setNumWritten (juce::int64 n) noexcept   { jassert (n <= capacity); numWritten = n; }
+
+    int getCapacity() const noexcept              { return capacity; }
+    juce::int64 getNumWritten() const noexcept    { return numWritten; }
+    juce::int64 getNumAvailable() const noexcept  { return juce::jmin (numWritten, (juce::int64) capacity); }
+    juce::int64 getOldest() const noexcept        { return numWritten - getNumAvailable(); }
+
+    // The window [start, end) in absolute positions, clipped to what is retained.
+    Spans getSpans (juce::int64 start, juce::int64 end) const noexcept
+    {
+        start = juce::jmax (start, getOldest());
+        end = juce::jmin (end, numWritten);
+
+        if (start >= end)
+            return {};
+
+        const int first = (int) (start & mask);
+        const int total = (int) (end - start);
+        const int size1 = juce::jmin (total, capacity - first);
+
+        return { data.get() + first, size1, data.get(), total - size1 };
+    }
+
+private:
+    const int capacity;
+    const juce::int64 mask;
+    juce::HeapBlock<T> data;
+    juce::int64 numWritten = 0;
+};
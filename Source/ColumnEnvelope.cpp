@@ -0,0 +1,151 @@
+#include "ColumnEnvelope.h"
+
+void ColumnEnvelope::reserve (int numColumnsToReserve)
+{
+    const auto size = (size_t) juce::jmax (0, numColumnsToReserve);
+
+    if (rmsMin.size() < size)
+    {
+        rmsMin.resize (size);
+        rmsMax.resize (size);
+        peakMax.resize (size);
+        truePeakMax.resize (size);
+    }
+}
+
+void ColumnEnvelope::compute (const HistoryStore& history, int first, int end, float zoomX, juce::int64 framesAgo,
+                              int rmsLane, int peakLane, int truePeakLane)
+{
+    hasTruePeak = truePeakLane >= 0 && history.hasTruePeakLane();
+
+    computeColumns (first, end, zoomX, framesAgo, rmsLane, peakLane, truePeakLane,
+                    [&history] (int lane, juce::int64 ago, juce::int64 numFrames, MinMax& result)
+                    {
+                        return history.getRange (lane, ago, numFrames, result);
+                    });
+}
+
+void ColumnEnvelope::compute (const MinMaxPyramid<LogLevelCodec16>& rms, const MinMaxPyramid<LogLevelCodec16>& peak,
+                              int first, int end, float zoomX)
+{
+    hasTruePeak = false;
+
+    computeColumns (first, end, zoomX, 0, HistoryStore::rmsLane, HistoryStore::peakLane, -1,
+                    [&rms, &peak] (int lane, juce::int64 ago, juce::int64 numFrames, MinMax& result)
+                    {
+                        return (lane == HistoryStore::peakLane ? peak : rms).getRange (ago, numFrames, result);
+                    });
+}
+
+template <typename RangeQuery>
+void ColumnEnvelope::computeColumns (int first, int end, float zoomX, juce::int64 framesAgo,
+                                     int rmsLane, int peakLane, int truePeakLane, RangeQuery&& getRange)
+{
+    const auto size = (size_t) juce::jmax (0, end);
+
+    // Only grows, so steady-state calls do not allocate
+    reserve ((int) size);
+
+    const double samplesPerPixel = 1.0 / (double) zoomX;
+    firstColumn = juce::jlimit (0, (int) size, first);
+    numColumns = firstColumn;
+
+    for (int column = firstColumn; column < (int) size; ++column)
+    {
+        // Calculate Range in Buffer
+        juce::int64 iStart = framesAgo + (juce::int64) ((double) column * samplesPerPixel);
+        juce::int64 iEnd   = framesAgo + (juce::int64) ((double) (column + 1) * samplesPerPixel);
+        if (iEnd <= iStart) iEnd = iStart + 1;
+
+        MinMax range;
+        if (! getRange (rmsLane, iStart, iEnd - iStart, range))
+            break; // Everything further left is older than the recorded history
+
+        MinMax peakRange;
+        if (peakLane < 0 || ! getRange (peakLane, iStart, iEnd - iStart, peakRange))
+            peakRange = range;
+
+        // The lane may start later than the others; columns before it show the sample peak
+        MinMax truePeakRange;
+        if (hasTruePeak && ! getRange (truePeakLane, iStart, iEnd - iStart, truePeakRange))
+            truePeakRange = peakRange;
+
+        rmsMin[(size_t) column] = range.min;
+        rmsMax[(size_t) column] = range.max;
+        peakMax[(size_t) column] = peakRange.max;
+        truePeakMax[(size_t) column] = hasTruePeak ? truePeakRange.max : 0.0f;
+        ++numColumns;
+    }
+}
+
+int ColumnEnvelope::paint (juce::Graphics& g, const ScopeMapping& mapping, float w, juce::Colour colour,
+                           float minThickness, float fillAlpha, juce::Path& fillPath, juce::Path& peakPath) const
+{
+    if (numColumns <= firstColumn)
+        return 0;
+
+    fillPath.clear();
+    peakPath.clear();
+
+    // Trace Roof (Right to Left)
+    for (int c = firstColumn; c < numColumns; ++c)
+    {
+        const float x = w - (float) c;
+        float yMax = mapping.toY (rmsMax[(size_t) c]);
+        float yMin = mapping.toY (rmsMin[(size_t) c]);
+        ScopeMapping::enforceThickness (yMax, yMin, minThickness);
+
+        const float yPeak = mapping.toY (peakMax[(size_t) c]);
+
+        if (c == firstColumn) { fillPath.startNewSubPath (x, yMax); peakPath.startNewSubPath (x, yPeak); }
+        else                  { fillPath.lineTo (x, yMax); peakPath.lineTo (x, yPeak); }
+    }
+
+    // Trace Floor (Left to Right) to close the polygon.
+    for (int c = numColumns - 1; c >= firstColumn; --c)
+    {
+        float yMax = mapping.toY (rmsMax[(size_t) c]);
+        float yMin = mapping.toY (rmsMin[(size_t) c]);
+        ScopeMapping::enforceThickness (yMax, yMin, minThickness);
+
+        fillPath.lineTo (w - (float) c, yMin);
+    }
+
+    fillPath.closeSubPath();
+
+    // Peak is drawn as a faint line behind the RMS trace
+    g.setColour (colour.withAlpha (0.35f));
+    g.strokePath (peakPath, juce::PathStrokeType (1.0f));
+
+    // Draw solid
+    g.setColour (colour.withAlpha (fillAlpha));
+    g.fillPath (fillPath);
+
+    // Lighter stroke on edges for definition
+    g.setColour (colour);
+    g.strokePath (fillPath, juce::PathStrokeType (1.0f));
+
+    // Roof, floor and peak line
+    int numPoints = 3 * (numColumns - firstColumn);
+
+    if (hasTruePeak)
+    {
+        // The peak path has been stroked already, so it is reused as scratch
+        peakPath.clear();
+
+        for (int c = firstColumn; c < numColumns; ++c)
+        {
+            const float x = w - (float) c;
+            const float y = mapping.toY (truePeakMax[(size_t) c]);
+
+            if (c == firstColumn) peakPath.startNewSubPath (x, y);
+            else                  peakPath.lineTo (x, y);
+        }
+
+        g.setColour (juce::Colours::orange.withAlpha (0.6f));
+        g.strokePath (peakPath, juce::PathStrokeType (1.0f));
+        numPoints += numColumns - firstColumn;
+    }
+
+    return numPoints;
+}
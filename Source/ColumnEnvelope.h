@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+
+// Maps a level onto the screen the same way in every renderer.
+struct ScopeMapping
+{
+    float height = 0.0f;
+    float zoomY = 1.0f;
+    float top = 0.0f; // offset of the strip, for stacked lanes
+
+    float toY (float level) const noexcept
+    {
+        const float midY = height * 0.5f;
+        return top + juce::jlimit (0.0f, height, midY - (level * midY * 0.9f * zoomY));
+    }
+
+    // Contiguous version of toY(); a plain loop with no wrap logic, so it auto-vectorises.
+    void toY (const float* levels, float* ys, int numValues) const noexcept
+    {
+        const float midY = height * 0.5f;
+        const float scale = midY * 0.9f * zoomY;
+
+        for (int i = 0; i < numValues; ++i)
+            ys[i] = top + juce::jlimit (0.0f, height, midY - levels[i] * scale);
+    }
+
+    // --- THICKNESS ENFORCEMENT ---
+    // If the tube is too thin, widen it artificially. This fixes the "Moiré Shivering".
+    static void enforceThickness (float& yMax, float& yMin, float minThickness = 1.5f) noexcept
+    {
+        if (std::abs (yMin - yMax) < minThickness)
+        {
+            const float center = (yMax + yMin) * 0.5f;
+            yMax = center - (minThickness * 0.5f);
+            yMin = center + (minThickness * 0.5f);
+        }
+    }
+};
+
+// Pixel Grouping: the history reduced to one Min/Max (RMS) and Max (peak) per
+// screen column, newest column (the right edge) first. Only the columns
+// [firstColumn, numColumns) are valid; see LodPlan for how the range is chosen.
+//
+// Each column is a single O(log N) pyramid query, so computing the envelope
+// costs O(width) no matter how many samples a pixel covers. The result is
+// independent of the renderer and shared by the software and OpenGL paths.
+// Columns older than the RAM ring come from the disk-backed history, if enabled.
+struct ColumnEnvelope
+{
+    std::vector<float> rmsMin, rmsMax, peakMax, truePeakMax;
+    int firstColumn = 0;
+    int numColumns = 0;
+    bool hasTruePeak = false; // truePeakMax is valid
+
+    // Grows the column storage ahead of time, so compute() does not allocate.
+    void reserve (int numColumnsToReserve);
+
+    // Reduces the columns [first, end), stopping early where the history runs out.
+    // framesAgo is the position of the right edge (0 = the newest frame), so a view
+    // that is panned back or paused reads from further in the past.
+    // Must be called with the history lock held. Any lane can be reduced (see
+    // HistoryStore::getChannelLane()); a negative peakLane mirrors rmsMax into peakMax.
+    // The true-peak lane is reduced too if one is given and the history has it.
+    void compute (const HistoryStore& history, int first, int end, float zoomX, juce::int64 framesAgo,
+                  int rmsLane = HistoryStore::rmsLane, int peakLane = HistoryStore::peakLane,
+                  int truePeakLane = HistoryStore::truePeakLane);
+
+    // Same for a bare RMS / peak pyramid pair, e.g. a stream received by SmoothScopeViewer.
+    void compute (const MinMaxPyramid<LogLevelCodec16>& rms, const MinMaxPyramid<LogLevelCodec16>& peak,
+                  int first, int end, float zoomX);
+
+    // Fills and strokes the envelope with its peak line behind it, column c at x = w - c.
+    // The true-peak line, if any, is stroked on top as a second layer.
+    // The paths are scratch supplied by the caller so they can be reused across frames.
+    // Returns the number of path points emitted.
+    int paint (juce::Graphics& g, const ScopeMapping& mapping, float w, juce::Colour colour,
+                float minThickness, float fillAlpha, juce::Path& fillPath, juce::Path& peakPath) const;
+
+private:
+    // getRange (lane, framesAgo, numFrames, result) answers the queries of both compute()s
+    template <typename RangeQuery>
+    void computeColumns (int first, int end, float zoomX, juce::int64 framesAgo,
+                         int rmsLane, int peakLane, int truePeakLane, RangeQuery&& getRange);
+};
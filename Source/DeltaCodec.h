@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelCodec.h"
+
+// Levels as deltas between consecutive Codec codes, written as zig-zag varints.
+//
+// Level traces move slowly from frame to frame, so most deltas take one byte;
+// the result also deflates well. Shared by the state format (SavedHistory) and
+// the network broadcast (LevelBroadcast).
+template <typename Codec>
+struct DeltaCodec
+{
+    static void write (juce::OutputStream& out, const float* levels, int numFrames)
+    {
+        int previous = 0;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const int code = (int) Codec::encode (levels[i]);
+            const int delta = code - previous;
+            previous = code;
+
+            // Zig-zag, so small steps either way take one byte
+            auto value = ((juce::uint32) delta << 1) ^ (juce::uint32) (delta >> 31);
+
+            while (value >= 0x80)
+            {
+                out.writeByte ((char) (value | 0x80));
+                value >>= 7;
+            }
+
+            out.writeByte ((char) value);
+        }
+    }
+
+    // Parses from a buffer rather than a stream: one virtual read (and, behind a
+    // GZIPDecompressorInputStream, one inflate call) per byte is far slower than the
+    // decoding itself. Advances pos past the bytes used. Returns false if the data
+    // runs out before end or a code is out of range.
+    static bool read (const juce::uint8*& pos, const juce::uint8* end, float* levels, int numFrames)
+    {
+        int previous = 0;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            juce::uint32 value = 0;
+
+            for (int shift = 0;; shift += 7)
+            {
+                if (shift > 28 || pos == end)
+                    return false;
+
+                const juce::uint8 byte = *pos++;
+
+                value |= (juce::uint32) (byte & 0x7f) << shift;
+
+                if ((byte & 0x80) == 0)
+                    break;
+            }
+
+            const int code = previous + ((int) (value >> 1) ^ -(int) (value & 1));
+
+            if (code < 0 || code > Codec::maxCode)
+                return false;
+
+            levels[i] = Codec::decode ((typename Codec::Stored) code);
+            previous = code;
+        }
+
+        return true;
+    }
+};
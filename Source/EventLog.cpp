@@ -0,0 +1,180 @@
+#include "EventLog.h"
+
+void EventLog::prepare (double newFrameRate)
+{
+    frameRate = newFrameRate;
+
+    minSilenceFrames = juce::jmax ((juce::int64) 1, (juce::int64) std::ceil (thresholds.minSilenceSeconds * frameRate));
+    mergeFrames = juce::jmax ((juce::int64) 1, (juce::int64) std::round (thresholds.mergeSeconds * frameRate));
+}
+
+void EventLog::setThresholds (const Thresholds& newThresholds)
+{
+    thresholds = newThresholds;
+    prepare (frameRate);
+}
+
+void EventLog::reset() noexcept
+{
+    for (auto& ring : events)
+        ring.clear();
+
+    for (auto& detector : detectors)
+        detector.active = false;
+
+    nextFrame = 0;
+}
+
+void EventLog::push (juce::int64 frame, float peak) noexcept
+{
+    if (frame != nextFrame)
+        for (int type = 0; type < numTypes; ++type)
+            close (type);
+
+    nextFrame = frame + 1;
+
+    const bool hits[numTypes] { peak >= thresholds.clipLevel, peak >= thresholds.overLevel, peak < thresholds.silenceLevel };
+
+    for (int type = 0; type < numTypes; ++type)
+    {
+        auto& detector = detectors[type];
+
+        if (hits[type])
+        {
+            if (! detector.active)
+            {
+                detector.active = true;
+                detector.event = { frame, frame + 1, peak, type };
+            }
+
+            detector.event.end = frame + 1;
+            detector.event.level = juce::jmax (detector.event.level, peak);
+            detector.lastHit = frame;
+        }
+        else if (detector.active && (type == silence || frame - detector.lastHit >= mergeFrames))
+        {
+            // A silence ends with the first frame above it; clips and overs wait out the merge gap
+            close (type);
+        }
+    }
+}
+
+void EventLog::close (int type) noexcept
+{
+    auto& detector = detectors[type];
+
+    if (! detector.active)
+        return;
+
+    detector.active = false;
+
+    // Quiet passages shorter than the minimum are not dropouts
+    if (type != silence || detector.event.end - detector.event.start >= minSilenceFrames)
+        events[type].push (detector.event);
+}
+
+bool EventLog::getOpen (int type, Event& result) const noexcept
+{
+    const auto& detector = detectors[type];
+
+    if (! detector.active || (type == silence && detector.event.end - detector.event.start < minSilenceFrames))
+        return false;
+
+    result = detector.event;
+    return true;
+}
+
+juce::int64 EventLog::firstEndingAfter (int type, juce::int64 frame) const noexcept
+{
+    const auto& ring = events[type];
+    auto lo = ring.getOldest(), hi = ring.getNumWritten();
+
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+
+        if (ring[mid].end > frame) hi = mid;
+        else                       lo = mid + 1;
+    }
+
+    return lo;
+}
+
+juce::int64 EventLog::firstStartingAfter (int type, juce::int64 frame) const noexcept
+{
+    const auto& ring = events[type];
+    auto lo = ring.getOldest(), hi = ring.getNumWritten();
+
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+
+        if (ring[mid].start > frame) hi = mid;
+        else                         lo = mid + 1;
+    }
+
+    return lo;
+}
+
+bool EventLog::findNext (juce::int64 frame, int typeMask, Event& result) const noexcept
+{
+    bool found = false;
+
+    for (int type = 0; type < numTypes; ++type)
+    {
+        if ((typeMask & (1 << type)) == 0)
+            continue;
+
+        const auto& ring = events[type];
+        const auto i = firstStartingAfter (type, frame);
+
+        // Past the closed events, the open one is next
+        Event candidate;
+        bool hasCandidate = i < ring.getNumWritten();
+
+        if (hasCandidate) candidate = ring[i];
+        else              hasCandidate = getOpen (type, candidate) && candidate.start > frame;
+
+        if (hasCandidate && (! found || candidate.start < result.start))
+        {
+            result = candidate;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool EventLog::findPrevious (juce::int64 frame, int typeMask, Event& result) const noexcept
+{
+    bool found = false;
+
+    for (int type = 0; type < numTypes; ++type)
+    {
+        if ((typeMask & (1 << type)) == 0)
+            continue;
+
+        const auto& ring = events[type];
+
+        // The open event started after every closed one
+        Event candidate;
+        bool hasCandidate = getOpen (type, candidate) && candidate.start < frame;
+
+        if (! hasCandidate)
+        {
+            const auto i = firstStartingAfter (type, frame - 1) - 1;
+            hasCandidate = i >= ring.getOldest();
+
+            if (hasCandidate)
+                candidate = ring[i];
+        }
+
+        if (hasCandidate && (! found || candidate.start > result.start))
+        {
+            result = candidate;
+            found = true;
+        }
+    }
+
+    return found;
+}
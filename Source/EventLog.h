@@ -0,0 +1,129 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularHistory.h"
+
+// Threshold events in the mix, found as the history is recorded: clips, peaks
+// over a threshold, and silences (dropouts) longer than a minimum duration.
+//
+// The history thread pushes the peak of every frame it drains. Each type keeps
+// at most one open event; hits less than mergeSeconds apart are joined, so a
+// burst of clipped samples is one event rather than hundreds. Closed events go
+// into one CircularHistory per type. Events of a type never overlap and are
+// closed in order, so each ring is sorted by start and by end at once, and
+// next / previous / range queries are binary searches: O(log N) however long
+// the session, without touching the history itself. An open event is reported
+// too, up to the newest frame, so markers appear as soon as it starts.
+//
+// Frames are counted in the same absolute positions as the HistoryStore pyramids.
+// Written by the history thread; read under the history lock.
+class EventLog
+{
+public:
+    enum Type { clip, over, silence, numTypes };
+
+    struct Thresholds
+    {
+        float clipLevel = 0.999f;      // full scale, give or take rounding
+        float overLevel = 0.891f;      // -1 dBFS; clips are overs too
+        float silenceLevel = 0.001f;   // -60 dBFS peak
+        double minSilenceSeconds = 2.0;
+        double mergeSeconds = 0.1;     // clips and overs closer than this are one event
+    };
+
+    struct Event
+    {
+        juce::int64 start = 0, end = 0; // absolute frames [start, end)
+        float level = 0.0f;             // highest peak inside
+        int type = clip;
+    };
+
+    // ~16k events per type, allocated lazily like the history (~1.2 MB at most)
+    static constexpr int capacityPerType = 1 << 14;
+
+    EventLog() = default;
+
+    // The durations are counted in frames, so a new hop rate needs them converted again.
+    void prepare (double frameRate);
+    double getFrameRate() const noexcept { return frameRate; }
+
+    // Applies to frames pushed from now on.
+    void setThresholds (const Thresholds& newThresholds);
+    const Thresholds& getThresholds() const noexcept { return thresholds; }
+
+    // Forgets every event, e.g. when the history is replaced.
+    void reset() noexcept;
+
+    // frame must follow the previous one; a gap closes the open events first.
+    void push (juce::int64 frame, float peak) noexcept;
+
+    // The first event of any type in typeMask (bit 1 << type) starting after frame,
+    // or the last one starting before it. False if there is none.
+    bool findNext (juce::int64 frame, int typeMask, Event& result) const noexcept;
+    bool findPrevious (juce::int64 frame, int typeMask, Event& result) const noexcept;
+
+    // Calls callback (const Event&) for each event of the type overlapping [start, end), oldest first.
+    template <typename Callback>
+    void forEach (int type, juce::int64 start, juce::int64 end, Callback&& callback) const
+    {
+        const auto& ring = events[type];
+
+        for (auto i = firstEndingAfter (type, start); i < ring.getNumWritten() && ring[i].start < end; ++i)
+            callback (ring[i]);
+
+        Event open;
+        if (getOpen (type, open) && open.end > start && open.start < end)
+            callback (open);
+    }
+
+    // Same, thinned out for drawing: after each event reported, the ones ending less than
+    // minFrameStep frames after it are skipped with a binary search. With minFrameStep
+    // the frames of one pixel, this costs O(pixels * log N) however many events there are.
+    template <typename Callback>
+    void forEach (int type, juce::int64 start, juce::int64 end, juce::int64 minFrameStep, Callback&& callback) const
+    {
+        const auto& ring = events[type];
+        const auto step = juce::jmax ((juce::int64) 1, minFrameStep);
+
+        for (auto i = firstEndingAfter (type, start); i < ring.getNumWritten() && ring[i].start < end;)
+        {
+            const Event event = ring[i];
+            callback (event);
+            i = juce::jmax (i + 1, firstEndingAfter (type, event.end + step - 1));
+        }
+
+        Event open;
+        if (getOpen (type, open) && open.end > start && open.start < end)
+            callback (open);
+    }
+
+    // Events recorded so far of one type, including those that no longer fit the ring.
+    juce::int64 getNumEvents (int type) const noexcept { return events[type].getNumWritten(); }
+
+private:
+    struct Detector
+    {
+        bool active = false;
+        Event event;
+        juce::int64 lastHit = 0;
+    };
+
+    void close (int type) noexcept;
+    bool getOpen (int type, Event& result) const noexcept;
+
+    // Index of the first retained event of the type ending after frame (getNumWritten() if none)
+    juce::int64 firstEndingAfter (int type, juce::int64 frame) const noexcept;
+    juce::int64 firstStartingAfter (int type, juce::int64 frame) const noexcept;
+
+    Thresholds thresholds;
+    double frameRate = 0.0;
+    juce::int64 minSilenceFrames = 1, mergeFrames = 1;
+    juce::int64 nextFrame = 0;
+
+    Detector detectors[numTypes];
+    CircularHistory<Event> events[numTypes] { CircularHistory<Event> (capacityPerType),
+                                              CircularHistory<Event> (capacityPerType),
+                                              CircularHistory<Event> (capacityPerType) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EventLog)
+};
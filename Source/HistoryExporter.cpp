@@ -0,0 +1,244 @@
+#include "HistoryExporter.h"
+
+HistoryExporter::HistoryExporter (const HistoryStore& historyToUse)
+    : juce::Thread ("SmoothScope Export"), history (historyToUse)
+{
+}
+
+HistoryExporter::~HistoryExporter()
+{
+    stopThread (5000);
+}
+
+bool HistoryExporter::start (const Options& newOptions)
+{
+    if (isThreadRunning())
+        return false;
+
+    options = newOptions;
+    progress.store (0.0f, std::memory_order_relaxed);
+
+    return startThread (juce::Thread::Priority::low);
+}
+
+void HistoryExporter::cancel()
+{
+    signalThreadShouldExit();
+}
+
+juce::Result HistoryExporter::getLastResult() const
+{
+    const juce::ScopedLock sl (resultLock);
+    return lastResult;
+}
+
+void HistoryExporter::run()
+{
+    juce::int64 firstFrame = 0;
+    auto result = takeSnapshot (firstFrame);
+
+    if (result.wasOk())
+    {
+        // Written next to the target and moved into place at the end, so a failed
+        // or cancelled export never leaves a truncated file behind.
+        juce::TemporaryFile temp (options.file);
+
+        {
+            juce::FileOutputStream out (temp.getFile(), 1 << 20);
+
+            if (! out.openedOk())
+                result = juce::Result::fail ("Could not create " + temp.getFile().getFullPathName());
+            else if (options.format == Format::csv)
+                result = writeCsv (out, firstFrame);
+            else
+                result = writeBinary (out, rms.data(), peak.data(), (juce::int64) rms.size(), firstFrame, options.frameRate,
+                                      [this] (float fraction)
+                                      {
+                                          progress.store (0.2f + 0.8f * fraction, std::memory_order_relaxed);
+                                          return ! threadShouldExit();
+                                      });
+
+            if (result.wasOk())
+            {
+                out.flush();
+
+                if (out.getStatus().failed())
+                    result = out.getStatus();
+            }
+        }
+
+        if (result.wasOk() && ! temp.overwriteTargetFileWithTemporary())
+            result = juce::Result::fail ("Could not write " + options.file.getFullPathName());
+    }
+
+    // Release the snapshot; multi-hour captures are tens of megabytes
+    std::vector<float>().swap (rms);
+    std::vector<float>().swap (peak);
+
+    const juce::ScopedLock sl (resultLock);
+    lastResult = result;
+}
+
+juce::Result HistoryExporter::takeSnapshot (juce::int64& firstFrame)
+{
+    juce::int64 start, end;
+
+    {
+        const juce::ScopedLock sl (history.getLock());
+        const auto& pyramid = history.getPyramid();
+
+        start = juce::jmax (options.startFrame, pyramid.getNumWritten() - pyramid.getNumAvailable());
+        end = juce::jmin (options.endFrame, pyramid.getNumWritten());
+    }
+
+    if (start >= end)
+        return juce::Result::fail ("Nothing to export in the selected range");
+
+    firstFrame = start;
+    const auto numFrames = end - start;
+    rms.resize ((size_t) numFrames);
+    peak.resize ((size_t) numFrames);
+
+    // Oldest first: new frames only ever overwrite the oldest end of the ring, and
+    // one slice is copied far faster than the ring can wrap past it.
+    for (auto pos = start; pos < end; pos += sliceFrames)
+    {
+        if (threadShouldExit())
+            return juce::Result::fail ("Export cancelled");
+
+        const auto length = juce::jmin (sliceFrames, end - pos);
+        const auto offset = (size_t) (pos - start);
+
+        const juce::ScopedLock sl (history.getLock());
+        const auto& pyramid = history.getPyramid();
+
+        if (pos < pyramid.getNumWritten() - pyramid.getNumAvailable())
+            return juce::Result::fail ("History was overwritten during the export");
+
+        const auto framesAgo = pyramid.getNumWritten() - (pos + length);
+        pyramid.readRaw (framesAgo, length, rms.data() + offset);
+        history.getPeakPyramid().readRaw (framesAgo, length, peak.data() + offset);
+
+        // The snapshot is the quick part; give it a fifth of the progress bar
+        progress.store (0.2f * (float) (pos + length - start) / (float) numFrames, std::memory_order_relaxed);
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result HistoryExporter::writeBinary (juce::OutputStream& out, const float* rms, const float* peak,
+                                          juce::int64 numFrames, juce::int64 firstFrame, double frameRate,
+                                          const std::function<bool (float)>& onProgress)
+{
+    Header header {};
+    std::memcpy (header.magic, "SSX1", 4);
+    header.version = 1;
+    header.firstFrame = firstFrame;
+    header.numFrames = numFrames;
+    header.frameRate = frameRate;
+    header.numLanes = 2;
+    header.sampleFormat = 0;
+
+    if (! out.write (&header, sizeof (header)))
+        return juce::Result::fail ("Write failed");
+
+    // Interleave a block at a time into a small staging buffer
+    constexpr int blockFrames = 4096;
+    float block[blockFrames * 2];
+
+    for (juce::int64 pos = 0; pos < numFrames; pos += blockFrames)
+    {
+        const int count = (int) juce::jmin ((juce::int64) blockFrames, numFrames - pos);
+
+        for (int i = 0; i < count; ++i)
+        {
+            block[2 * i]     = rms[pos + i];
+            block[2 * i + 1] = peak[pos + i];
+        }
+
+        if (! out.write (block, (size_t) count * 2 * sizeof (float)))
+            return juce::Result::fail ("Write failed");
+
+        if (onProgress != nullptr && ! onProgress ((float) (pos + count) / (float) numFrames))
+            return juce::Result::fail ("Export cancelled");
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result HistoryExporter::readBinary (juce::InputStream& in, std::vector<float>& rms, std::vector<float>& peak,
+                                         double& frameRate, juce::int64 maxFrames, juce::int64& numSkipped)
+{
+    Header header {};
+
+    if (in.read (&header, sizeof (header)) != (int) sizeof (header) || std::memcmp (header.magic, "SSX1", 4) != 0)
+        return juce::Result::fail ("Not a SmoothScope history file");
+
+    // Divided rather than multiplied, so a corrupt frame count cannot overflow past the check
+    if (header.version > 1 || header.numLanes != 2 || header.sampleFormat != 0 || header.numFrames < 0
+         || header.numFrames > in.getNumBytesRemaining() / (2 * (juce::int64) sizeof (float)))
+        return juce::Result::fail ("Unsupported or truncated history file");
+
+    // Frames are fixed size, so the newest ones are one seek away
+    numSkipped = juce::jmax ((juce::int64) 0, header.numFrames - juce::jmax ((juce::int64) 0, maxFrames));
+    const auto numFrames = header.numFrames - numSkipped;
+
+    if (numSkipped > 0 && ! in.setPosition (in.getPosition() + numSkipped * 2 * (juce::int64) sizeof (float)))
+        return juce::Result::fail ("Truncated history file");
+
+    rms.resize ((size_t) numFrames);
+    peak.resize ((size_t) numFrames);
+    frameRate = header.frameRate;
+
+    constexpr int blockFrames = 4096;
+    float block[blockFrames * 2];
+
+    for (juce::int64 pos = 0; pos < numFrames; pos += blockFrames)
+    {
+        const int count = (int) juce::jmin ((juce::int64) blockFrames, numFrames - pos);
+        const int bytes = count * 2 * (int) sizeof (float);
+
+        if (in.read (block, bytes) != bytes)
+            return juce::Result::fail ("Truncated history file");
+
+        for (int i = 0; i < count; ++i)
+        {
+            rms[(size_t) (pos + i)]  = block[2 * i];
+            peak[(size_t) (pos + i)] = block[2 * i + 1];
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result HistoryExporter::writeCsv (juce::OutputStream& out, juce::int64 firstFrame)
+{
+    const auto numFrames = (juce::int64) rms.size();
+    const char* headerLine = "frame,seconds,rms,peak\n";
+
+    if (! out.write (headerLine, std::strlen (headerLine)))
+        return juce::Result::fail ("Write failed");
+
+    char line[128];
+
+    for (juce::int64 i = 0; i < numFrames; ++i)
+    {
+        if ((i & 0xffff) == 0)
+        {
+            if (threadShouldExit())
+                return juce::Result::fail ("Export cancelled");
+
+            progress.store (0.2f + 0.8f * (float) i / (float) numFrames, std::memory_order_relaxed);
+        }
+
+        const auto frame = firstFrame + i;
+        const int length = std::snprintf (line, sizeof (line), "%lld,%.3f,%.6g,%.6g\n",
+                                          (long long) frame, (double) frame / options.frameRate,
+                                          (double) rms[(size_t) i], (double) peak[(size_t) i]);
+
+        if (! out.write (line, (size_t) length))
+            return juce::Result::fail ("Write failed");
+    }
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+
+// Writes the RAM history (or a range of it) to disk on its own thread.
+//
+// The export first takes a snapshot: the requested frames are copied out of the
+// ring oldest first, in short slices, each under the history lock for only a few
+// tens of microseconds, so the FIFO drain never stalls and the audio thread never
+// drops frames. Only then is the copy streamed to a temporary file through a large
+// buffered stream, which replaces the target once everything has been written.
+//
+// Binary layout (.ssx, little endian on every supported platform):
+//   Header (64 bytes)
+//   numFrames x { float rms, float peak }
+//
+// CSV layout: a "frame,seconds,rms,peak" header line, then one line per frame.
+class HistoryExporter : private juce::Thread
+{
+public:
+    enum class Format { binary, csv };
+
+    struct Options
+    {
+        juce::File file;
+        Format format = Format::binary;
+
+        // Absolute frames [startFrame, endFrame), clipped to what the ring still holds
+        juce::int64 startFrame = 0;
+        juce::int64 endFrame = std::numeric_limits<juce::int64>::max();
+
+        double frameRate = 100.0;
+    };
+
+    explicit HistoryExporter (const HistoryStore& historyToUse);
+    ~HistoryExporter() override;
+
+    // Returns false if an export is already running.
+    bool start (const Options& options);
+    void cancel();
+
+    bool isExporting() const noexcept { return isThreadRunning(); }
+    float getProgress() const noexcept { return progress.load (std::memory_order_relaxed); }
+
+    // Outcome of the most recent export that finished
+    juce::Result getLastResult() const;
+
+    // --- The binary format on its own (also used by SmoothScopeAnalyze and for importing) ---
+    // onProgress (fraction) may return false to cancel.
+    static juce::Result writeBinary (juce::OutputStream& out, const float* rms, const float* peak,
+                                     juce::int64 numFrames, juce::int64 firstFrame, double frameRate,
+                                     const std::function<bool (float)>& onProgress = {});
+
+    // Reads an .ssx stream; the lanes come back oldest first. Only the newest maxFrames
+    // frames are read: the stream seeks past any before them, and numSkipped receives
+    // how many that was.
+    static juce::Result readBinary (juce::InputStream& in, std::vector<float>& rms, std::vector<float>& peak,
+                                    double& frameRate, juce::int64 maxFrames, juce::int64& numSkipped);
+
+    struct Header
+    {
+        char magic[4];             // "SSX1"
+        juce::uint32 version;
+        juce::int64 firstFrame;    // absolute position of the first frame
+        juce::int64 numFrames;
+        double frameRate;
+        juce::uint32 numLanes;     // 2: rms, peak
+        juce::uint32 sampleFormat; // 0 = float32
+        juce::uint8 reserved[24];
+    };
+
+    static_assert (sizeof (Header) == 64, "Export header layout must stay fixed");
+
+private:
+    void run() override;
+
+    juce::Result takeSnapshot (juce::int64& firstFrame);
+    juce::Result writeCsv (juce::OutputStream& out, juce::int64 firstFrame);
+
+    const HistoryStore& history;
+    Options options;
+
+    // The snapshot; only touched by the export thread
+    std::vector<float> rms, peak;
+
+    std::atomic<float> progress { 0.0f };
+
+    juce::CriticalSection resultLock;
+    juce::Result lastResult { juce::Result::ok() };
+
+    // Frames copied per history lock
+    static constexpr juce::int64 sliceFrames = 16384;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryExporter)
+};
@@ -0,0 +1,47 @@
+#include "HistoryImporter.h"
+#include "HistoryExporter.h"
+
+HistoryImporter::HistoryImporter (HistoryStore& historyToUse)
+    : juce::Thread ("SmoothScope Import"), history (historyToUse)
+{
+}
+
+HistoryImporter::~HistoryImporter()
+{
+    stopThread (5000);
+}
+
+bool HistoryImporter::start (const juce::File& fileToRead, std::function<void (const Outcome&)> callback)
+{
+    if (isThreadRunning())
+        return false;
+
+    file = fileToRead;
+    onFinished = std::move (callback);
+
+    return startThread (juce::Thread::Priority::low);
+}
+
+void HistoryImporter::run()
+{
+    Outcome outcome;
+    outcome.file = file;
+
+    {
+        std::vector<float> rms, peak;
+        juce::FileInputStream in (file);
+
+        outcome.result = in.openedOk() ? HistoryExporter::readBinary (in, rms, peak, outcome.frameRate,
+                                                                      HistoryStore::historySize, outcome.numSkipped)
+                                       : juce::Result::fail ("Could not open " + file.getFileName());
+
+        if (outcome.result.wasOk())
+        {
+            outcome.numFrames = (juce::int64) rms.size();
+            history.restore (rms.data(), peak.data(), outcome.numFrames);
+        }
+    }
+
+    if (onFinished != nullptr)
+        juce::MessageManager::callAsync ([callback = onFinished, outcome] { callback (outcome); });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+
+// Loads an .ssx file (see HistoryExporter) into the history on its own thread.
+//
+// Only the newest HistoryStore::historySize frames are read; restore() would
+// drop anything older, so the reader seeks straight past it. Reading and the
+// parallel pyramid rebuild both happen off the message thread, and the outcome
+// is handed back on the message thread once the new history is in place.
+class HistoryImporter : private juce::Thread
+{
+public:
+    struct Outcome
+    {
+        juce::File file;
+        juce::Result result { juce::Result::ok() };
+        double frameRate = 0.0;   // as recorded in the file
+        juce::int64 numFrames = 0, numSkipped = 0; // loaded, and older ones left out
+    };
+
+    explicit HistoryImporter (HistoryStore& historyToUse);
+    ~HistoryImporter() override;
+
+    // --- Message thread ---
+    // Returns false if an import is already running. onFinished is called on the
+    // message thread (via MessageManager::callAsync), so it should not assume the
+    // caller is still alive: capture a Component::SafePointer.
+    bool start (const juce::File& file, std::function<void (const Outcome&)> onFinished);
+
+    bool isImporting() const noexcept { return isThreadRunning(); }
+
+private:
+    void run() override;
+
+    HistoryStore& history;
+    juce::File file;
+    std::function<void (const Outcome&)> onFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryImporter)
+};
@@ -0,0 +1,50 @@
+#include "HistoryPrefetcher.h"
+
+HistoryPrefetcher::HistoryPrefetcher (const HistoryStore& historyToUse)
+    : history (historyToUse)
+{
+}
+
+HistoryPrefetcher::~HistoryPrefetcher()
+{
+    pool->remove (*this);
+}
+
+void HistoryPrefetcher::request (const View& view)
+{
+    if (view == lastRequested || view.width <= 0 || view.zoomX <= 0.0f)
+        return;
+
+    lastRequested = view;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (pendingLock);
+        pendingView = view;
+        hasPending = true;
+    }
+
+    pool->schedule (*this);
+}
+
+void HistoryPrefetcher::renderPending()
+{
+    View view;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (pendingLock);
+
+        if (! hasPending)
+            return;
+
+        view = pendingView;
+        hasPending = false;
+    }
+
+    const double framesPerColumn = 1.0 / (double) view.zoomX;
+    const auto span = (juce::int64) std::ceil ((double) view.width * framesPerColumn);
+    const auto startFrame = view.endFrame - span;
+
+    // Each side starts at the edge, so what scrolls in first is paged in first
+    history.prefetch (startFrame, startFrame - span, framesPerColumn);
+    history.prefetch (view.endFrame, view.endFrame + span, framesPerColumn);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+#include "RenderWorkerPool.h"
+
+// Warms the disk-backed history just beyond both edges of the view, on the
+// shared RenderWorkerPool, so panning and scrubbing find the chunk files
+// already mapped and resident instead of stalling paint() on a page fault.
+//
+// request() hands over the view after every pan or zoom; identical views are
+// ignored and one that arrives mid-prefetch is picked up right after it. One
+// view width is prefetched on either side: older frames to the left, and to
+// the right the frames between a paused view and the write head.
+class HistoryPrefetcher : private RenderWorkerPool::Client
+{
+public:
+    struct View
+    {
+        juce::int64 endFrame = -1; // absolute frame just past the right edge
+        int width = 0;
+        float zoomX = 1.0f;
+
+        bool operator== (const View& other) const noexcept
+        {
+            return endFrame == other.endFrame && width == other.width && zoomX == other.zoomX;
+        }
+
+        bool operator!= (const View& other) const noexcept { return ! operator== (other); }
+    };
+
+    explicit HistoryPrefetcher (const HistoryStore& historyToUse);
+    ~HistoryPrefetcher() override;
+
+    // --- Message thread ---
+    void request (const View& view);
+
+private:
+    void renderPending() override;
+
+    const HistoryStore& history;
+    juce::SharedResourcePointer<RenderWorkerPool> pool;
+
+    juce::SpinLock pendingLock;
+    View pendingView;
+    bool hasPending = false;
+    View lastRequested; // message thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryPrefetcher)
+};
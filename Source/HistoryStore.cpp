@@ -0,0 +1,458 @@
+#include "HistoryStore.h"
+#include "PluginProcessor.h"
+
+HistoryStore::HistoryStore (SmoothScopeAudioProcessor& p)
+    : juce::Thread ("SmoothScope History"), audioProcessor (p),
+      pendingBandLevels ((size_t) SmoothScopeAudioProcessor::fifoSize * SpectralAnalyser::numBands)
+{
+    startThread (juce::Thread::Priority::low);
+}
+
+HistoryStore::~HistoryStore()
+{
+    stopThread (1000);
+}
+
+void HistoryStore::run()
+{
+    while (! threadShouldExit())
+    {
+        drainFifo();
+        wait (drainIntervalMs);
+    }
+}
+
+void HistoryStore::drainFifo()
+{
+    juce::int64 written = -1;
+    std::shared_ptr<PersistentHistory> persistentToFlush;
+    std::vector<std::unique_ptr<BandPyramid>> droppedBandPyramids;
+
+    // Take everything that is ready with one acquire, publish with one release.
+    // This thread is the only reader, so the FIFO itself needs no lock.
+    auto spans = audioProcessor.fifo.prepareRead();
+    const int numFrames = spans.getTotalSize();
+
+    // The FFTs run before the history lock is taken, so paint, export and range
+    // queries never wait for them; under the lock the levels are only pushed.
+    bool anyBands = false;
+    int index = 0;
+
+    spans.forEach ([&] (const LevelFrame& frame)
+    {
+        if (frame.hasBands)
+            spectralAnalyser.analyse (audioProcessor.getSpectralTap(), frame.endSample,
+                                      pendingBandLevels.data() + (size_t) index * SpectralAnalyser::numBands);
+
+        anyBands = anyBands || frame.hasBands;
+        ++index;
+    });
+
+    // Likewise a new set of band lanes is built here and swapped in by pushFrame()
+    if (anyBands && spareBandPyramids.empty() && getNumBandLanesLocked() == 0)
+        for (int b = 0; b < SpectralAnalyser::numBands; ++b)
+            spareBandPyramids.push_back (std::make_unique<BandPyramid> (historySize));
+
+    {
+        const juce::ScopedLock sl (lock);
+        persistentToFlush = persistent;
+
+        audioProcessor.getStats().recordDrain (numFrames);
+
+        if (numFrames > 0)
+        {
+            index = 0;
+
+            spans.forEach ([&] (const LevelFrame& frame)
+            {
+                pushFrame (frame, pendingBandLevels.data() + (size_t) index++ * SpectralAnalyser::numBands,
+                           droppedBandPyramids);
+            });
+
+            audioProcessor.fifo.commitRead (numFrames);
+            written = pyramid.getNumWritten();
+        }
+    }
+
+    if (written >= 0)
+        numWritten.store (written, std::memory_order_release);
+
+    // Band lanes that were switched off are freed outside the lock too
+    droppedBandPyramids.clear();
+
+    // Chunk files are written outside the lock so readers never wait on disk I/O
+    if (persistentToFlush != nullptr)
+        persistentToFlush->flushPending();
+}
+
+int HistoryStore::getNumBandLanesLocked() const
+{
+    const juce::ScopedLock sl (lock);
+    return getNumBandLanes();
+}
+
+void HistoryStore::pushFrame (const LevelFrame& frame, const float* bandLevels,
+                              std::vector<std::unique_ptr<BandPyramid>>& droppedBandPyramids)
+{
+    // A new bus layout starts a fresh set of channel lanes
+    if (frame.numChannels != (int) channelPyramids.size())
+    {
+        channelPyramids.clear();
+        channelLaneStart = pyramid.getNumWritten();
+
+        for (int ch = 0; ch < frame.numChannels; ++ch)
+            channelPyramids.push_back (std::make_unique<ChannelPyramid> (historySize));
+    }
+
+    // Switching true-peak off drops the lane; switching it on starts a new one here
+    if (frame.hasTruePeak != (truePeakPyramid != nullptr))
+    {
+        truePeakPyramid = frame.hasTruePeak ? std::make_unique<ChannelPyramid> (historySize) : nullptr;
+        truePeakLaneStart = pyramid.getNumWritten();
+    }
+
+    // Likewise for the loudness lanes; integration starts over with them
+    if (frame.hasLoudness != (momentaryPyramid != nullptr))
+    {
+        momentaryPyramid = frame.hasLoudness ? std::make_unique<ChannelPyramid> (historySize) : nullptr;
+        shortTermPyramid = frame.hasLoudness ? std::make_unique<ChannelPyramid> (historySize) : nullptr;
+        loudnessLaneStart = pyramid.getNumWritten();
+        loudnessMeter.reset();
+    }
+
+    // Likewise for the band lanes, swapping in the set drainFifo() built outside the lock
+    if (frame.hasBands != ! bandPyramids.empty())
+    {
+        for (auto& bandPyramid : bandPyramids)
+            droppedBandPyramids.push_back (std::move (bandPyramid));
+
+        bandPyramids.clear();
+        bandLaneStart = pyramid.getNumWritten();
+
+        if (frame.hasBands)
+        {
+            std::swap (bandPyramids, spareBandPyramids);
+
+            // Only if the lanes were dropped by restore() between the two
+            while (bandPyramids.size() < (size_t) SpectralAnalyser::numBands)
+                bandPyramids.push_back (std::make_unique<BandPyramid> (historySize));
+        }
+    }
+
+    // Durations are counted in hops, like the loudness windows
+    if (eventLog.getFrameRate() != audioProcessor.getFrameRate())
+        eventLog.prepare (audioProcessor.getFrameRate());
+
+    eventLog.push (pyramid.getNumWritten(), frame.peak);
+
+    // Update Raw History + Pyramid (amortised O(1) per value)
+    pyramid.push (frame.rms);
+    peakPyramid.push (frame.peak);
+    levelSums.push ((double) frame.rms);
+    energySums.push ((double) frame.rms * (double) frame.rms);
+
+    for (int ch = 0; ch < frame.numChannels; ++ch)
+        channelPyramids[(size_t) ch]->push (frame.channelRms[ch]);
+
+    if (truePeakPyramid != nullptr)
+        truePeakPyramid->push (frame.truePeak);
+
+    if (momentaryPyramid != nullptr)
+    {
+        // The windows are counted in hops, so a new sample rate needs new ones
+        if (loudnessMeter.getFrameRate() != audioProcessor.getFrameRate())
+            loudnessMeter.prepare (audioProcessor.getFrameRate());
+
+        loudnessMeter.push (frame.loudnessEnergy);
+        momentaryPyramid->push ((float) std::sqrt (loudnessMeter.getMomentaryEnergy()));
+        shortTermPyramid->push ((float) std::sqrt (loudnessMeter.getShortTermEnergy()));
+    }
+
+    if (! bandPyramids.empty())
+    {
+        for (int b = 0; b < SpectralAnalyser::numBands; ++b)
+            bandPyramids[(size_t) b]->push (bandLevels[b]);
+    }
+
+    if (persistent != nullptr)
+        persistent->append ({ frame.rms, frame.peak });
+
+    audioProcessor.getLevelPublisher().append (frame);
+}
+
+void HistoryStore::setPersistenceEnabled (bool shouldBeEnabled)
+{
+    if (! shouldBeEnabled)
+        persistenceFailed.store (false, std::memory_order_relaxed);
+
+    if (shouldBeEnabled == isPersistenceEnabled())
+        return;
+
+    if (! shouldBeEnabled)
+    {
+        const juce::ScopedLock sl (lock);
+        persistent.reset();
+        return;
+    }
+
+    auto directory = PersistentHistory::getDefaultRootDirectory()
+                         .getChildFile (juce::Time::getCurrentTime().formatted ("%Y-%m-%d_%H-%M-%S"));
+
+    // File I/O stays outside the lock, like the chunk writes
+    const bool created = directory.createDirectory().wasOk();
+    persistenceFailed.store (! created, std::memory_order_relaxed);
+
+    if (! created)
+        return;
+
+    const juce::ScopedLock sl (lock);
+
+    // Chunks are aligned to absolute frame positions: start with the chunk the
+    // write head is in and backfill its first part from the RAM ring.
+    const auto written = pyramid.getNumWritten();
+    const auto firstFrame = (written / PersistentHistory::chunkFrames) * PersistentHistory::chunkFrames;
+
+    auto newPersistent = std::make_shared<PersistentHistory> (directory, audioProcessor.getFrameRate(), firstFrame);
+
+    for (auto i = firstFrame; i < written; ++i)
+        newPersistent->append ({ pyramid.getSample (written - 1 - i), peakPyramid.getSample (written - 1 - i) });
+
+    persistent = std::move (newPersistent);
+}
+
+void HistoryStore::restore (const float* rmsFrames, const float* peakFrames, juce::int64 numFrames)
+{
+    juce::SharedResourcePointer<RenderWorkerPool> pool;
+
+    const ParallelFor parallelFor = [&pool] (int numTasks, const std::function<void (int)>& task)
+    {
+        pool->parallelFor (numTasks, task);
+    };
+
+    juce::int64 written;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        pyramid.assign (rmsFrames, numFrames, parallelFor);
+        peakPyramid.assign (peakFrames, numFrames, parallelFor);
+
+        // A running sum is sequential by nature, but only two adds per frame
+        levelSums.clear();
+        energySums.clear();
+
+        for (auto i = numFrames - pyramid.getNumWritten(); i < numFrames; ++i)
+        {
+            levelSums.push ((double) rmsFrames[i]);
+            energySums.push ((double) rmsFrames[i] * (double) rmsFrames[i]);
+        }
+
+        // Likewise the event detection, on the frame positions the pyramids now use
+        eventLog.reset();
+        eventLog.prepare (audioProcessor.getFrameRate());
+
+        for (juce::int64 frame = 0; frame < pyramid.getNumWritten(); ++frame)
+            eventLog.push (frame, peakFrames[numFrames - pyramid.getNumWritten() + frame]);
+
+        channelPyramids.clear();
+        channelLaneStart = pyramid.getNumWritten();
+        truePeakPyramid.reset();
+        momentaryPyramid.reset();
+        shortTermPyramid.reset();
+        bandPyramids.clear();
+        persistent.reset();
+
+        written = pyramid.getNumWritten();
+    }
+
+    numWritten.store (written, std::memory_order_release);
+    ++generation; // the count alone may not change
+}
+
+bool HistoryStore::getRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result) const
+{
+    return getRangeAbsolute (lane, start, end, result, false);
+}
+
+bool HistoryStore::getOverviewRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result) const
+{
+    return getRangeAbsolute (lane, start, end, result, true);
+}
+
+bool HistoryStore::getRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result,
+                                     bool diskSummariesOnly) const
+{
+    if (lane >= firstBandLane)
+    {
+        // Band lanes are RAM only and count frames from bandLaneStart
+        const auto band = (size_t) (lane - firstBandLane);
+
+        return band < bandPyramids.size()
+                && bandPyramids[band]->getRangeAbsolute (start - bandLaneStart, end - bandLaneStart, result);
+    }
+
+    if (lane >= firstChannelLane)
+    {
+        // Channel lanes are RAM only and count frames from channelLaneStart
+        const auto channel = (size_t) (lane - firstChannelLane);
+
+        return channel < channelPyramids.size()
+                && channelPyramids[channel]->getRangeAbsolute (start - channelLaneStart, end - channelLaneStart, result);
+    }
+
+    if (lane == momentaryLane || lane == shortTermLane)
+    {
+        // RAM only, counting frames from loudnessLaneStart
+        const auto& lanePyramid = (lane == momentaryLane) ? momentaryPyramid : shortTermPyramid;
+
+        return lanePyramid != nullptr
+                && lanePyramid->getRangeAbsolute (start - loudnessLaneStart, end - loudnessLaneStart, result);
+    }
+
+    if (lane == truePeakLane)
+    {
+        // RAM only, counting frames from truePeakLaneStart
+        return truePeakPyramid != nullptr
+                && truePeakPyramid->getRangeAbsolute (start - truePeakLaneStart, end - truePeakLaneStart, result);
+    }
+
+    const auto& lanePyramid = (lane == peakLane) ? peakPyramid : pyramid;
+    const auto oldestInRam = lanePyramid.getNumWritten() - lanePyramid.getNumAvailable();
+
+    bool found = false;
+    MinMax part;
+
+    if (end > oldestInRam && lanePyramid.getRangeAbsolute (juce::jmax (start, oldestInRam), end, part))
+    {
+        result = part;
+        found = true;
+    }
+
+    const auto diskEnd = juce::jmin (end, oldestInRam);
+
+    if (start < oldestInRam && persistent != nullptr
+         && (diskSummariesOnly ? persistent->getSummaryRange (lane, start, diskEnd, part)
+                               : persistent->getRange (lane, start, diskEnd, part)))
+    {
+        result = found ? MinMax { juce::jmin (result.min, part.min), juce::jmax (result.max, part.max) } : part;
+        found = true;
+    }
+
+    return found;
+}
+
+juce::int64 HistoryStore::getFirstFrame() const noexcept
+{
+    const auto oldestInRam = pyramid.getNumWritten() - pyramid.getNumAvailable();
+    return persistent != nullptr ? juce::jmin (oldestInRam, persistent->getFirstFrame()) : oldestInRam;
+}
+
+void HistoryStore::prefetch (juce::int64 from, juce::int64 to, double framesPerColumn) const
+{
+    std::shared_ptr<PersistentHistory> disk;
+    juce::int64 oldestInRam;
+
+    {
+        const juce::ScopedLock sl (lock);
+        disk = persistent;
+        oldestInRam = pyramid.getNumWritten() - pyramid.getNumAvailable();
+    }
+
+    if (disk == nullptr || framesPerColumn <= 0.0)
+        return;
+
+    // Only the part older than the RAM ring is read from disk
+    const auto lo = juce::jmax (juce::jmin (from, to), disk->getFirstFrame());
+    const auto hi = juce::jmin (juce::jmax (from, to), oldestInRam, disk->getEndFrame());
+
+    if (lo >= hi)
+        return;
+
+    // A query only opens the chunks it covers partly; whole chunks come from their summary
+    constexpr auto chunkFrames = (juce::int64) PersistentHistory::chunkFrames;
+    const double step = from <= to ? framesPerColumn : -framesPerColumn;
+    const auto numColumns = (juce::int64) std::ceil ((double) std::abs (to - from) / framesPerColumn);
+
+    juce::int64 lastChunk = -1;
+    int numChunks = 0;
+
+    auto prefetchChunk = [&] (juce::int64 chunk)
+    {
+        if (chunk == lastChunk)
+            return;
+
+        lastChunk = chunk;
+        disk->prefetch (chunk);
+        ++numChunks;
+    };
+
+    for (juce::int64 column = 0; column <= numColumns && numChunks < PersistentHistory::maxPrefetchChunks; ++column)
+    {
+        const auto a = from + (juce::int64) ((double) column * step);
+        const auto b = from + (juce::int64) ((double) (column + 1) * step);
+        const auto start = juce::jmax (lo, juce::jmin (a, b));
+        const auto end = juce::jmin (hi, juce::jmax (juce::jmax (a, b), start + 1));
+
+        if (start >= end)
+            continue;
+
+        // Visit the chunk nearest to `from` first
+        const auto first = start / chunkFrames, last = (end - 1) / chunkFrames;
+        const bool firstIsPartial = start % chunkFrames != 0 || end < (first + 1) * chunkFrames;
+        const bool lastIsPartial = last != first && end % chunkFrames != 0;
+
+        if (step > 0.0)
+        {
+            if (firstIsPartial) prefetchChunk (first);
+            if (lastIsPartial)  prefetchChunk (last);
+        }
+        else
+        {
+            if (lastIsPartial)  prefetchChunk (last);
+            if (firstIsPartial) prefetchChunk (first);
+        }
+    }
+}
+
+bool HistoryStore::getRangeStats (juce::int64 start, juce::int64 end, RangeStats& result) const
+{
+    juce::int64 numFrames = 0;
+    const double levelSum = levelSums.getSum (start, end, numFrames);
+    const double energySum = energySums.getSum (start, end, numFrames);
+
+    // Same clipping as the sums, so every figure describes the same frames
+    start = juce::jmax (start, levelSums.getOldest());
+    end = start + numFrames;
+
+    MinMax levels, peaks;
+
+    if (numFrames == 0 || ! pyramid.getRangeAbsolute (start, end, levels) || ! peakPyramid.getRangeAbsolute (start, end, peaks))
+        return false;
+
+    result.numFrames = numFrames;
+    result.meanLevel = (float) (levelSum / (double) numFrames);
+    result.rms = (float) std::sqrt (juce::jmax (0.0, energySum / (double) numFrames));
+    result.minLevel = levels.min;
+    result.maxLevel = levels.max;
+    result.peak = peaks.max;
+    return true;
+}
+
+HistoryStore::Loudness HistoryStore::getLoudness() const noexcept
+{
+    if (momentaryPyramid == nullptr)
+    {
+        constexpr auto silence = -std::numeric_limits<float>::infinity();
+        return { silence, silence, silence };
+    }
+
+    return { LoudnessMeter::energyToLufs (loudnessMeter.getMomentaryEnergy()),
+             LoudnessMeter::energyToLufs (loudnessMeter.getShortTermEnergy()),
+             loudnessMeter.getIntegratedLufs() };
+}
+
+bool HistoryStore::getRange (int lane, juce::int64 framesAgo, juce::int64 numFrames, MinMax& result) const
+{
+    const auto written = pyramid.getNumWritten();
+    return getRangeAbsolute (lane, written - framesAgo - numFrames, written - juce::jmax ((juce::int64) 0, framesAgo), result);
+}
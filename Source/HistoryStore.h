@@ -0,0 +1,209 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MinMaxPyramid.h"
+#include "PrefixSum.h"
+#include "PersistentHistory.h"
+#include "LevelAnalyser.h"
+#include "RenderWorkerPool.h"
+#include "SpectralAnalyser.h"
+#include "LoudnessMeter.h"
+#include "EventLog.h"
+
+class SmoothScopeAudioProcessor;
+
+// Processor-owned level history.
+//
+// A low-priority background thread drains the processor's FIFO into the
+// pyramid, so recording carries on while no editor is open. Editors attach
+// as read-only views: they hold getLock() while reading the pyramid and poll
+// getNumWritten() to find out whether anything new arrived.
+//
+// Optionally every frame is also appended to a PersistentHistory on disk, and
+// range queries older than the RAM ring are answered from there.
+class HistoryStore : private juce::Thread
+{
+public:
+    // 1 Million frames at the 10 ms analysis hop ~ 2.9 hours, independent of
+    // the host's sample rate and block size.
+    static constexpr int historySize = 1048576;
+
+    // Storage format of the RAM history, see SMOOTHSCOPE_HISTORY_BITS in LevelCodec.h.
+    using Pyramid = MinMaxPyramid<HistoryCodec>;
+
+    explicit HistoryStore (SmoothScopeAudioProcessor& processor);
+    ~HistoryStore() override;
+
+    // Must be held while reading from getPyramid().
+    const juce::CriticalSection& getLock() const noexcept { return lock; }
+    const Pyramid& getPyramid() const noexcept { return pyramid; }         // RMS lane
+    const Pyramid& getPeakPyramid() const noexcept { return peakPyramid; } // Peak lane
+
+    // Cheap lock-free "has anything changed?" check for the editor timer.
+    juce::int64 getNumWritten() const noexcept { return numWritten.load (std::memory_order_acquire); }
+
+    // Bumped whenever the history is replaced wholesale (see restore()), so views know to redraw everything.
+    int getGeneration() const noexcept { return generation.load (std::memory_order_acquire); }
+
+    // --- Range queries over RAM + disk ---
+    // Channel c of the input bus is lane firstChannelLane + c, spectral band b is lane firstBandLane + b.
+    enum Lane { rmsLane = 0, peakLane = 1, truePeakLane = 2, momentaryLane = 3, shortTermLane = 4, firstChannelLane = 5,
+                firstBandLane = firstChannelLane + LevelFrame::maxChannels };
+
+    static constexpr int getChannelLane (int channel) noexcept { return firstChannelLane + channel; }
+    static constexpr int getBandLane (int band) noexcept { return firstBandLane + band; }
+
+    // Number of per-channel lanes; follows the bus layout. Call with getLock() held.
+    int getNumChannelLanes() const noexcept { return (int) channelPyramids.size(); }
+
+    // Whether truePeakLane holds anything; it only exists while the processor's
+    // true-peak measurement is on. Call with getLock() held.
+    bool hasTruePeakLane() const noexcept { return truePeakPyramid != nullptr; }
+
+    // Whether momentaryLane and shortTermLane hold anything; they only exist while the
+    // processor's loudness measurement is on. Their levels are the square root of the
+    // mean K-weighted energy, so 20 log10 (level) - 0.691 is the loudness in LUFS
+    // (see levelToLufs()). Call with getLock() held.
+    bool hasLoudnessLanes() const noexcept { return momentaryPyramid != nullptr; }
+
+    struct Loudness
+    {
+        float momentary, shortTerm, integrated; // LUFS, -inf for silence
+    };
+
+    // The current readings, integrated since the loudness lanes started. Call with getLock() held.
+    Loudness getLoudness() const noexcept;
+
+    static float levelToLufs (float level) noexcept { return LoudnessMeter::energyToLufs ((double) level * (double) level); }
+
+    // Number of spectral band lanes: SpectralAnalyser::numBands while band analysis
+    // is on, otherwise 0. Call with getLock() held.
+    int getNumBandLanes() const noexcept { return (int) bandPyramids.size(); }
+
+    // Min/Max of a lane over absolute frames [start, end); the part older than the
+    // RAM ring comes from the persistent store, if enabled. Call with getLock() held.
+    bool getRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result) const;
+
+    // Same, but any part older than the RAM ring comes from the disk's per-chunk summaries
+    // only (see PersistentHistory::getSummaryRange()), widened to whole chunks. Never maps
+    // a chunk file, so a whole-session overview can be drawn on the paint thread.
+    bool getOverviewRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result) const;
+
+    // Same, with 0 = newest frame.
+    bool getRange (int lane, juce::int64 framesAgo, juce::int64 numFrames, MinMax& result) const;
+
+    // Oldest frame the mix lanes can still answer for: the start of the disk recording,
+    // if there is one, otherwise of the RAM ring. Call with getLock() held.
+    juce::int64 getFirstFrame() const noexcept;
+
+    // Pages in the disk chunks that column queries from frame `from` towards frame `to`
+    // (either direction) will need, nearest first, framesPerColumn frames per column.
+    // Up to PersistentHistory::maxPrefetchChunks files are mapped and faulted in.
+    // Only takes the history lock briefly, so it can run on a worker while the editor
+    // paints; call it without getLock() held. Does nothing without persistence.
+    void prefetch (juce::int64 from, juce::int64 to, double framesPerColumn) const;
+
+    // --- Range statistics ---
+    struct RangeStats
+    {
+        juce::int64 numFrames = 0;
+        float meanLevel = 0.0f;          // average of the RMS lane
+        float rms = 0.0f;                // square root of its mean energy
+        float minLevel = 0.0f, maxLevel = 0.0f;
+        float peak = 0.0f;               // highest sample peak
+    };
+
+    // Statistics of the mix over absolute frames [start, end), clipped to the RAM ring.
+    // Mean and RMS come from prefix sums in O(1), the extremes from the pyramids in
+    // O(log N), so even a selection over the whole history costs a handful of reads.
+    // Returns false if no frame of the range is retained. Call with getLock() held.
+    bool getRangeStats (juce::int64 start, juce::int64 end, RangeStats& result) const;
+
+    // --- Events ---
+    // Clips, overs and silences of the mix, detected as frames are recorded (see EventLog),
+    // on the same frame positions as the pyramids. Call with getLock() held.
+    const EventLog& getEventLog() const noexcept { return eventLog; }
+
+    // --- Bulk load ---
+    // Replaces the mix and peak history with numFrames frames (oldest first), e.g. after
+    // restoring a saved session. The pyramids are rebuilt in parallel on the shared
+    // RenderWorkerPool, and the events are detected again from the peaks. Channel, true-peak, loudness and band lanes start over, and a running disk recording is
+    // stopped, since its frame positions no longer line up.
+    void restore (const float* rmsFrames, const float* peakFrames, juce::int64 numFrames);
+
+    // --- Disk-backed long-term history (message thread) ---
+    // Starts a new recording session directory under PersistentHistory::getDefaultRootDirectory().
+    void setPersistenceEnabled (bool shouldBeEnabled);
+    bool isPersistenceEnabled() const noexcept { return persistent != nullptr; }
+
+    // True if the last recording could not be started (no session directory) or
+    // stopped because its chunks could not be written (see PersistentHistory::hasFailed()).
+    // Call with getLock() held.
+    bool hasPersistenceFailed() const noexcept
+    {
+        return persistenceFailed.load (std::memory_order_relaxed) || (persistent != nullptr && persistent->hasFailed());
+    }
+
+private:
+    void run() override;
+    void drainFifo();
+
+    bool getRangeAbsolute (int lane, juce::int64 start, juce::int64 end, MinMax& result, bool diskSummariesOnly) const;
+
+    SmoothScopeAudioProcessor& audioProcessor;
+
+    juce::CriticalSection lock;
+    Pyramid pyramid { historySize };
+    Pyramid peakPyramid { historySize };
+    std::atomic<juce::int64> numWritten { 0 };
+
+    // Prefix sums of the RMS lane and of its square, on the same positions as pyramid (16 MB)
+    PrefixSum levelSums { historySize }, energySums { historySize };
+    std::atomic<int> generation { 0 };
+
+    // Per-channel RMS lanes. Kept in 16-bit log storage so that one instance on a
+    // 12 or 16 channel bus stays far cheaper than one instance per channel.
+    // They are (re)created when the channel count changes, starting at frame channelLaneStart.
+    using ChannelPyramid = MinMaxPyramid<LogLevelCodec16>;
+    std::vector<std::unique_ptr<ChannelPyramid>> channelPyramids;
+    juce::int64 channelLaneStart = 0;
+
+    // Same storage for the optional true-peak lane, created with the first frame that has one
+    std::unique_ptr<ChannelPyramid> truePeakPyramid;
+    juce::int64 truePeakLaneStart = 0;
+
+    // Momentary and short-term loudness lanes, created with the first frame that has loudness
+    std::unique_ptr<ChannelPyramid> momentaryPyramid, shortTermPyramid;
+    juce::int64 loudnessLaneStart = 0;
+    LoudnessMeter loudnessMeter;
+
+    EventLog eventLog;
+
+    // Spectral band lanes, 8-bit log storage (~1.7 MB per band), created while band analysis is on
+    using BandPyramid = MinMaxPyramid<LogLevelCodec8>;
+    std::vector<std::unique_ptr<BandPyramid>> bandPyramids;
+    juce::int64 bandLaneStart = 0;
+
+    // History thread only: the analyser, the band levels of the frames being drained,
+    // and a set of band lanes built ahead of the frame that switches them on
+    SpectralAnalyser spectralAnalyser;
+    std::vector<float> pendingBandLevels; // one FIFO full
+    std::vector<std::unique_ptr<BandPyramid>> spareBandPyramids;
+
+    int getNumBandLanesLocked() const;
+
+    // Called with the lock held; bandLevels holds the frame's levels if it has bands.
+    // Band lanes it replaces go to droppedBandPyramids, to be freed after the lock.
+    void pushFrame (const LevelFrame& frame, const float* bandLevels,
+                    std::vector<std::unique_ptr<BandPyramid>>& droppedBandPyramids);
+
+    // Shared so the history thread can finish a flush even if persistence is switched off meanwhile.
+    std::shared_ptr<PersistentHistory> persistent;
+    std::atomic<bool> persistenceFailed { false };
+
+    // Poll interval of the consumer thread. At 100 frames per second the 1024 slot
+    // FIFO holds ~10 seconds, so this leaves plenty of headroom.
+    static constexpr int drainIntervalMs = 10;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HistoryStore)
+};
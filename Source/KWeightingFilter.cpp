@@ -0,0 +1,186 @@
+#include "KWeightingFilter.h"
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SMOOTHSCOPE_KWEIGHTING_NEON 1
+#elif defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64)
+ #include <immintrin.h>
+ #define SMOOTHSCOPE_KWEIGHTING_SSE 1
+#endif
+
+namespace
+{
+    constexpr int lanes = KWeightingFilter::channelsPerGroup;
+
+    // p[i] is lane i's channel; returns the sums of squares of the filtered samples [start, end) in sums.
+    template <typename Coefficients, typename GroupState>
+    [[maybe_unused]] void processGroupScalar (const Coefficients& c, GroupState& state, const float* const* p,
+                                              int start, int end, float* sums) noexcept
+    {
+        for (int i = 0; i < lanes; ++i)
+        {
+            float s1 = state.s1[i], s2 = state.s2[i], t1 = state.t1[i], t2 = state.t2[i];
+            float acc = 0.0f;
+
+            for (int n = start; n < end; ++n)
+            {
+                const float x = p[i][n];
+
+                const float y = c.b0 * x + s1;
+                s1 = c.b1 * x - c.a1 * y + s2;
+                s2 = c.b2 * x - c.a2 * y;
+
+                const float z = y + t1;
+                t1 = t2 - 2.0f * y - c.hpA1 * z;
+                t2 = y - c.hpA2 * z;
+
+                acc += z * z;
+            }
+
+            state.s1[i] = s1; state.s2[i] = s2; state.t1[i] = t1; state.t2[i] = t2;
+            sums[i] = acc;
+        }
+    }
+
+   #if SMOOTHSCOPE_KWEIGHTING_SSE
+
+    template <typename Coefficients, typename GroupState>
+    void processGroupSSE (const Coefficients& c, GroupState& state, const float* const* p,
+                          int start, int end, float* sums) noexcept
+    {
+        const __m128 b0 = _mm_set1_ps (c.b0), b1 = _mm_set1_ps (c.b1), b2 = _mm_set1_ps (c.b2);
+        const __m128 a1 = _mm_set1_ps (c.a1), a2 = _mm_set1_ps (c.a2);
+        const __m128 hpA1 = _mm_set1_ps (c.hpA1), hpA2 = _mm_set1_ps (c.hpA2);
+
+        __m128 s1 = _mm_load_ps (state.s1), s2 = _mm_load_ps (state.s2);
+        __m128 t1 = _mm_load_ps (state.t1), t2 = _mm_load_ps (state.t2);
+        __m128 acc = _mm_setzero_ps();
+
+        for (int n = start; n < end; ++n)
+        {
+            const __m128 x = _mm_setr_ps (p[0][n], p[1][n], p[2][n], p[3][n]);
+
+            const __m128 y = _mm_add_ps (_mm_mul_ps (b0, x), s1);
+            s1 = _mm_add_ps (_mm_sub_ps (_mm_mul_ps (b1, x), _mm_mul_ps (a1, y)), s2);
+            s2 = _mm_sub_ps (_mm_mul_ps (b2, x), _mm_mul_ps (a2, y));
+
+            const __m128 z = _mm_add_ps (y, t1);
+            t1 = _mm_sub_ps (_mm_sub_ps (t2, _mm_add_ps (y, y)), _mm_mul_ps (hpA1, z));
+            t2 = _mm_sub_ps (y, _mm_mul_ps (hpA2, z));
+
+            acc = _mm_add_ps (acc, _mm_mul_ps (z, z));
+        }
+
+        _mm_store_ps (state.s1, s1); _mm_store_ps (state.s2, s2);
+        _mm_store_ps (state.t1, t1); _mm_store_ps (state.t2, t2);
+        _mm_storeu_ps (sums, acc);
+    }
+
+   #endif
+
+   #if SMOOTHSCOPE_KWEIGHTING_NEON
+
+    template <typename Coefficients, typename GroupState>
+    void processGroupNeon (const Coefficients& c, GroupState& state, const float* const* p,
+                           int start, int end, float* sums) noexcept
+    {
+        float32x4_t s1 = vld1q_f32 (state.s1), s2 = vld1q_f32 (state.s2);
+        float32x4_t t1 = vld1q_f32 (state.t1), t2 = vld1q_f32 (state.t2);
+        float32x4_t acc = vdupq_n_f32 (0.0f);
+
+        for (int n = start; n < end; ++n)
+        {
+            const float gathered[lanes] { p[0][n], p[1][n], p[2][n], p[3][n] };
+            const float32x4_t x = vld1q_f32 (gathered);
+
+            const float32x4_t y = vmlaq_n_f32 (s1, x, c.b0);
+            s1 = vaddq_f32 (vmlsq_n_f32 (vmulq_n_f32 (x, c.b1), y, c.a1), s2);
+            s2 = vmlsq_n_f32 (vmulq_n_f32 (x, c.b2), y, c.a2);
+
+            const float32x4_t z = vaddq_f32 (y, t1);
+            t1 = vmlsq_n_f32 (vsubq_f32 (t2, vaddq_f32 (y, y)), z, c.hpA1);
+            t2 = vmlsq_n_f32 (y, z, c.hpA2);
+
+            acc = vmlaq_f32 (acc, z, z);
+        }
+
+        vst1q_f32 (state.s1, s1); vst1q_f32 (state.s2, s2);
+        vst1q_f32 (state.t1, t1); vst1q_f32 (state.t2, t2);
+        vst1q_f32 (sums, acc);
+    }
+
+   #endif
+
+    template <typename Coefficients, typename GroupState>
+    void processGroup (const Coefficients& c, GroupState& state, const float* const* p,
+                       int start, int end, float* sums) noexcept
+    {
+       #if SMOOTHSCOPE_KWEIGHTING_NEON
+        processGroupNeon (c, state, p, start, end, sums);
+       #elif SMOOTHSCOPE_KWEIGHTING_SSE
+        processGroupSSE (c, state, p, start, end, sums);
+       #else
+        processGroupScalar (c, state, p, start, end, sums);
+       #endif
+    }
+}
+
+void KWeightingFilter::prepare (double sampleRate) noexcept
+{
+    // BS.1770-4 stage 1: high shelf, +4 dB above ~1.7 kHz
+    {
+        constexpr double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow (10.0, gainDb / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        coefficients.b0 = (float) ((vh + vb * k / q + k * k) / a0);
+        coefficients.b1 = (float) (2.0 * (k * k - vh) / a0);
+        coefficients.b2 = (float) ((vh - vb * k / q + k * k) / a0);
+        coefficients.a1 = (float) (2.0 * (k * k - 1.0) / a0);
+        coefficients.a2 = (float) ((1.0 - k / q + k * k) / a0);
+    }
+
+    // Stage 2: the RLB high-pass at ~38 Hz
+    {
+        constexpr double f0 = 38.13547087602444, q = 0.5003270373238773;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        coefficients.hpA1 = (float) (2.0 * (k * k - 1.0) / a0);
+        coefficients.hpA2 = (float) ((1.0 - k / q + k * k) / a0);
+    }
+
+    reset();
+}
+
+void KWeightingFilter::reset() noexcept
+{
+    std::fill (std::begin (groups), std::end (groups), GroupState());
+}
+
+void KWeightingFilter::process (const float* const* channels, int numChannels, int startSample, int numSamples,
+                                double* sumSquares) noexcept
+{
+    jassert (numChannels <= maxChannels);
+
+    for (int first = 0; first < numChannels; first += channelsPerGroup)
+    {
+        // A partial group repeats its last channel in the spare lanes and ignores their results
+        const int count = juce::jmin (channelsPerGroup, numChannels - first);
+        const float* lanePointers[channelsPerGroup];
+
+        for (int i = 0; i < channelsPerGroup; ++i)
+            lanePointers[i] = channels[first + juce::jmin (i, count - 1)];
+
+        alignas (16) float sums[channelsPerGroup];
+        processGroup (coefficients, groups[first / channelsPerGroup], lanePointers,
+                      startSample, startSample + numSamples, sums);
+
+        for (int i = 0; i < count; ++i)
+            sumSquares[first + i] += (double) sums[i];
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// The ITU-R BS.1770-4 K-weighting pre-filter for up to maxChannels channels.
+//
+// K-weighting is two biquads in series: a +4 dB high shelf (the head) and the
+// RLB high-pass. A recursive filter cannot be vectorised along time, so four
+// channels are run side by side instead: their samples are gathered into one
+// vector and every coefficient is applied to all four at once, SSE2 on x86_64,
+// NEON on arm64. The filtered signal is never stored; only the sum of squares
+// is needed, so it is accumulated per channel on the way out.
+//
+// Coefficients are derived for any sample rate with the bilinear transform, from
+// the analogue prototype the recommendation's 48 kHz coefficients come from.
+class KWeightingFilter
+{
+public:
+    static constexpr int maxChannels = 16;
+    static constexpr int channelsPerGroup = 4;
+
+    void prepare (double sampleRate) noexcept;
+    void reset() noexcept;
+
+    // Filters samples [startSample, startSample + numSamples) of each channel and adds
+    // the sum of squares of the result to sumSquares[ch]. numChannels <= maxChannels.
+    void process (const float* const* channels, int numChannels, int startSample, int numSamples,
+                  double* sumSquares) noexcept;
+
+private:
+    static constexpr int numGroups = maxChannels / channelsPerGroup;
+
+    // Transposed direct form II, stage 2 (the high-pass) has b = { 1, -2, 1 }
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f; // head
+        float hpA1 = 0.0f, hpA2 = 0.0f;                               // RLB
+    };
+
+    // Filter state of four channels, one vector's worth each
+    struct alignas (16) GroupState
+    {
+        float s1[channelsPerGroup] {}, s2[channelsPerGroup] {}; // head
+        float t1[channelsPerGroup] {}, t2[channelsPerGroup] {}; // RLB
+    };
+
+    Coefficients coefficients;
+    GroupState groups[numGroups];
+};
@@ -0,0 +1,137 @@
+#include "LevelAnalyser.h"
+
+void LevelAnalyser::prepare (double sampleRate, double hopSeconds)
+{
+    hopSize = juce::jmax (1, juce::roundToInt (sampleRate * hopSeconds));
+    frameRate = sampleRate / (double) hopSize;
+
+    kWeighting.prepare (sampleRate);
+    std::fill (std::begin (loudnessWeights), std::end (loudnessWeights), 1.0f);
+
+    reset();
+}
+
+void LevelAnalyser::reset() noexcept
+{
+    hopCounter = 0;
+    samplesProcessed = 0;
+    std::fill (std::begin (channelMeasurements), std::end (channelMeasurements), BlockMeasurement());
+
+    for (auto& detector : truePeakDetectors)
+        detector.reset();
+
+    kWeighting.reset();
+    std::fill (std::begin (loudnessSumSquares), std::end (loudnessSumSquares), 0.0);
+}
+
+void LevelAnalyser::setChannelLayout (const juce::AudioChannelSet& layout) noexcept
+{
+    for (int ch = 0; ch < LevelFrame::maxChannels; ++ch)
+    {
+        const auto type = ch < layout.size() ? layout.getTypeOfChannel (ch) : juce::AudioChannelSet::unknown;
+
+        switch (type)
+        {
+            case juce::AudioChannelSet::LFE:
+            case juce::AudioChannelSet::LFE2:
+                loudnessWeights[ch] = 0.0f;
+                break;
+
+            case juce::AudioChannelSet::leftSurround:
+            case juce::AudioChannelSet::rightSurround:
+            case juce::AudioChannelSet::leftSurroundSide:
+            case juce::AudioChannelSet::rightSurroundSide:
+            case juce::AudioChannelSet::leftSurroundRear:
+            case juce::AudioChannelSet::rightSurroundRear:
+                loudnessWeights[ch] = 1.41f;
+                break;
+
+            default:
+                loudnessWeights[ch] = 1.0f;
+                break;
+        }
+    }
+}
+
+void LevelAnalyser::updateMeasurementState() noexcept
+{
+    // Start from silence rather than whatever the filters held when last switched off
+    const bool truePeak = truePeakRequested.load (std::memory_order_relaxed);
+
+    if (truePeak != truePeakActive)
+    {
+        if (truePeak)
+            for (auto& detector : truePeakDetectors)
+                detector.reset();
+
+        truePeakActive = truePeak;
+    }
+
+    const bool loudness = loudnessRequested.load (std::memory_order_relaxed);
+
+    if (loudness != loudnessActive)
+    {
+        if (loudness)
+        {
+            kWeighting.reset();
+            std::fill (std::begin (loudnessSumSquares), std::end (loudnessSumSquares), 0.0);
+        }
+
+        loudnessActive = loudness;
+    }
+}
+
+LevelFrame LevelAnalyser::finishFrame (int numChannels) noexcept
+{
+    LevelFrame frame;
+    frame.endSample = samplesProcessed;
+
+    if (numChannels > 0)
+    {
+        BlockMeasurement combined;
+
+        frame.numChannels = numChannels;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto& m = channelMeasurements[ch];
+            frame.channelRms[ch] = (float) std::sqrt (m.sumSquares / (double) hopSize);
+            frame.rms += frame.channelRms[ch];
+            combined.min = juce::jmin (combined.min, m.min);
+            combined.max = juce::jmax (combined.max, m.max);
+        }
+
+        frame.rms /= (float) numChannels;
+        frame.peak = combined.getPeak();
+        frame.min = combined.min;
+
+        if (truePeakActive)
+        {
+            // The interpolator's ~6 sample delay can shift a peak into the next hop;
+            // never report less than the sample peak of this one.
+            frame.hasTruePeak = true;
+            frame.truePeak = frame.peak;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                frame.truePeak = juce::jmax (frame.truePeak, truePeakDetectors[ch].getPeak());
+                truePeakDetectors[ch].resetPeak();
+            }
+        }
+
+        if (loudnessActive)
+        {
+            double energy = 0.0;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                energy += (double) loudnessWeights[ch] * loudnessSumSquares[ch];
+
+            frame.hasLoudness = true;
+            frame.loudnessEnergy = (float) (energy / (double) hopSize);
+            std::fill (std::begin (loudnessSumSquares), std::end (loudnessSumSquares), 0.0);
+        }
+    }
+
+    std::fill (std::begin (channelMeasurements), std::end (channelMeasurements), BlockMeasurement());
+    return frame;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelKernel.h"
+#include "TruePeakDetector.h"
+#include "KWeightingFilter.h"
+
+// One analysis hop as it travels through the FIFO.
+//
+// The broadband values summarise all channels; the per-channel levels are
+// stored structure-of-arrays style so consumers can walk one metric for every
+// channel contiguously.
+struct LevelFrame
+{
+    // Enough for 7.1.4 and 3rd order ambisonics; further channels are ignored.
+    static constexpr int maxChannels = 16;
+
+    float rms = 0.0f;   // average of the channels' RMS
+    float peak = 0.0f;  // highest absolute sample over all channels
+    float min = 0.0f;   // lowest (signed) sample over all channels
+
+    bool hasTruePeak = false;
+    float truePeak = 0.0f; // 4x oversampled peak over all channels, if hasTruePeak
+
+    // BS.1770 channel-weighted mean square of the K-weighted signal over the hop,
+    // if hasLoudness. The history thread turns these into LUFS (see LoudnessMeter).
+    bool hasLoudness = false;
+    float loudnessEnergy = 0.0f;
+
+    // Samples analysed since reset(), up to the end of this hop; matches the
+    // positions of the processor's SampleTap. hasBands asks the history thread
+    // to compute band levels for this frame (see SpectralAnalyser).
+    juce::int64 endSample = 0;
+    bool hasBands = false;
+
+    int numChannels = 0;
+    float channelRms[maxChannels] {};
+};
+
+// Fixed-hop level analysis.
+//
+// Accumulates sum-of-squares, minimum and maximum across host block boundaries
+// and emits exactly one LevelFrame every hopSize samples, so the frame rate
+// (and with it FIFO load and history duration) no longer depends on the host's
+// buffer size. Every sample is visited once, by the SIMD LevelKernel, and once
+// more by the TruePeakDetector and the KWeightingFilter while true-peak and
+// loudness measurement are switched on.
+class LevelAnalyser
+{
+public:
+    // 10 ms hop -> 100 frames per second at any sample rate.
+    static constexpr double defaultHopSeconds = 0.01;
+
+    void prepare (double sampleRate, double hopSeconds = defaultHopSeconds);
+    void reset() noexcept;
+
+    int getHopSize() const noexcept { return hopSize; }
+    double getFrameRate() const noexcept { return frameRate; }
+
+    // Can be called from any thread; the audio thread picks it up at the next block.
+    void setTruePeakEnabled (bool shouldBeEnabled) noexcept { truePeakRequested.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isTruePeakEnabled() const noexcept { return truePeakRequested.load (std::memory_order_relaxed); }
+
+    void setLoudnessEnabled (bool shouldBeEnabled) noexcept { loudnessRequested.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isLoudnessEnabled() const noexcept { return loudnessRequested.load (std::memory_order_relaxed); }
+
+    // BS.1770 channel weights for the loudness sum: 1.41 for the surrounds, 0 for
+    // the LFE and 1 for everything else. prepare() sets all channels to 1, so call
+    // this afterwards, and not while processing.
+    void setChannelLayout (const juce::AudioChannelSet& layout) noexcept;
+
+    // Feeds a block of audio and calls onFrame (const LevelFrame&) for every completed hop.
+    template <typename FrameCallback>
+    void process (const float* const* channels, int numChannels, int numSamples, FrameCallback&& onFrame)
+    {
+        numChannels = juce::jmin (numChannels, LevelFrame::maxChannels);
+        updateMeasurementState();
+
+        int pos = 0;
+
+        while (pos < numSamples)
+        {
+            const int chunk = juce::jmin (numSamples - pos, hopSize - hopCounter);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                LevelKernel::measure (channels[ch] + pos, chunk, channelMeasurements[ch]);
+
+            if (truePeakActive)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    truePeakDetectors[ch].process (channels[ch] + pos, chunk);
+
+            if (loudnessActive)
+                kWeighting.process (channels, numChannels, pos, chunk, loudnessSumSquares);
+
+            pos += chunk;
+            hopCounter += chunk;
+            samplesProcessed += chunk;
+
+            if (hopCounter >= hopSize)
+            {
+                onFrame (finishFrame (numChannels));
+                hopCounter = 0;
+            }
+        }
+    }
+
+private:
+    LevelFrame finishFrame (int numChannels) noexcept;
+    void updateMeasurementState() noexcept;
+
+    int hopSize = 441;
+    double frameRate = 100.0;
+
+    int hopCounter = 0;
+    juce::int64 samplesProcessed = 0;
+    BlockMeasurement channelMeasurements[LevelFrame::maxChannels];
+
+    std::atomic<bool> truePeakRequested { false };
+    bool truePeakActive = false; // audio thread's copy, fixed for a block
+    TruePeakDetector truePeakDetectors[LevelFrame::maxChannels];
+
+    std::atomic<bool> loudnessRequested { false };
+    bool loudnessActive = false;
+    KWeightingFilter kWeighting;
+    double loudnessSumSquares[LevelFrame::maxChannels] {};
+    float loudnessWeights[LevelFrame::maxChannels] {};
+
+    static_assert (KWeightingFilter::maxChannels >= LevelFrame::maxChannels, "K-weighting must cover every channel");
+};
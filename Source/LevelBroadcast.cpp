@@ -0,0 +1,56 @@
+#include "LevelBroadcast.h"
+#include "DeltaCodec.h"
+
+void LevelBroadcast::write (juce::MemoryOutputStream& out, juce::uint32 streamId, const juce::String& name, float frameRate,
+                            juce::int64 firstFrame, const float* rms, const float* peak, int numFrames)
+{
+    jassert (numFrames <= maxFramesPerPacket);
+
+    // Cut on a character boundary, so the name stays valid UTF-8
+    auto shortName = name;
+    while (shortName.getNumBytesAsUTF8() > (size_t) maxNameBytes)
+        shortName = shortName.dropLastCharacters (1);
+
+    out.writeInt (magic);
+    out.writeInt ((int) streamId);
+    out.writeByte ((char) shortName.getNumBytesAsUTF8());
+    out.write (shortName.toRawUTF8(), shortName.getNumBytesAsUTF8());
+    out.writeFloat (frameRate);
+    out.writeInt64 (firstFrame);
+    out.writeShort ((short) numFrames);
+
+    DeltaCodec<Codec>::write (out, rms, numFrames);
+    DeltaCodec<Codec>::write (out, peak, numFrames);
+}
+
+bool LevelBroadcast::read (const void* data, size_t size, Packet& packet)
+{
+    juce::MemoryInputStream in (data, size, false);
+
+    // Fixed part: magic, id, name length, frame rate, first frame, count
+    if (size < 4 + 4 + 1 + 4 + 8 + 2 || in.readInt() != magic)
+        return false;
+
+    packet.streamId = (juce::uint32) in.readInt();
+
+    const int nameBytes = (juce::uint8) in.readByte();
+    char name[maxNameBytes];
+
+    if (nameBytes > maxNameBytes || in.read (name, nameBytes) != nameBytes)
+        return false;
+
+    packet.name = juce::String::fromUTF8 (name, nameBytes);
+    packet.frameRate = in.readFloat();
+    packet.firstFrame = in.readInt64();
+    packet.numFrames = (juce::uint16) in.readShort();
+
+    if (in.isExhausted() || packet.numFrames > maxFramesPerPacket || ! (packet.frameRate > 0.0f))
+        return false;
+
+    // The lanes follow in the same buffer
+    const auto* pos = static_cast<const juce::uint8*> (data) + in.getPosition();
+    const auto* end = static_cast<const juce::uint8*> (data) + size;
+
+    return DeltaCodec<Codec>::read (pos, end, packet.rms, packet.numFrames)
+        && DeltaCodec<Codec>::read (pos, end, packet.peak, packet.numFrames);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelCodec.h"
+
+// Wire format of the level broadcast between LevelPublisher (in the plugin) and
+// SmoothScopeViewer.
+//
+// Each UDP datagram carries one batch of consecutive frames of one stream, small
+// enough to never be fragmented. Levels are LogLevelCodec16 codes, delta-coded
+// per packet (see DeltaCodec), so a packet decodes on its own and a lost one only
+// leaves a gap; frames are numbered so receivers can tell where it was.
+//
+// Packet layout (all integers little endian):
+//   "SSB1", uint32 streamId, uint8 nameBytes + UTF-8 name, float frameRate,
+//   int64 firstFrame, uint16 numFrames, RMS deltas, peak deltas
+struct LevelBroadcast
+{
+    // Administratively scoped multicast: stays within the site, and loopback
+    // delivers it to a viewer on the same machine too.
+    static constexpr const char* multicastGroup = "239.255.83.83";
+    static constexpr int defaultPort = 50515;
+
+    // Stays under a 1500 byte Ethernet MTU even when every delta needs 3 bytes
+    static constexpr int maxFramesPerPacket = 200;
+    static constexpr int maxNameBytes = 64;
+
+    using Codec = LogLevelCodec16;
+
+    struct Packet
+    {
+        juce::uint32 streamId = 0;
+        juce::String name;
+        float frameRate = 0.0f;
+        juce::int64 firstFrame = 0;
+        int numFrames = 0;
+        float rms[maxFramesPerPacket] {}, peak[maxFramesPerPacket] {};
+    };
+
+    // numFrames <= maxFramesPerPacket
+    static void write (juce::MemoryOutputStream& out, juce::uint32 streamId, const juce::String& name, float frameRate,
+                       juce::int64 firstFrame, const float* rms, const float* peak, int numFrames);
+
+    // Returns false for anything that is not a complete, well-formed packet.
+    static bool read (const void* data, size_t size, Packet& packet);
+
+    static constexpr int magic = 0x31425353; // "SSB1"
+};
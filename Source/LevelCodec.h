@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Storage formats for level history, selected at compile time through the
+// Codec parameter of MinMaxPyramid.
+//
+// Every codec is monotonic (a larger level never gets a smaller code), so
+// Min/Max can be computed directly on the stored values and only the final
+// result needs decoding.
+
+// Plain 32-bit floats: exact, 4 bytes per frame.
+struct FloatLevelCodec
+{
+    using Stored = float;
+
+    static Stored encode (float level) noexcept { return level; }
+    static float decode (Stored code) noexcept  { return code; }
+};
+
+// Log-domain (dB) quantisation into an unsigned integer. Code 0 is silence,
+// codes 1..max cover [minDb, maxDb] evenly; decoding is a table lookup.
+template <typename StorageType, int minDb, int maxDb>
+struct LogLevelCodec
+{
+    using Stored = StorageType;
+
+    static constexpr int maxCode = (int) std::numeric_limits<StorageType>::max();
+    static constexpr float dbPerStep = (float) (maxDb - minDb) / (float) (maxCode - 1);
+
+    static Stored encode (float level) noexcept
+    {
+        if (! (level > 0.0f))
+            return 0;
+
+        const float db = 20.0f * std::log10 (level);
+        const int code = 1 + juce::roundToInt ((db - (float) minDb) / dbPerStep);
+
+        return (Stored) juce::jlimit (1, maxCode, code);
+    }
+
+    static float decode (Stored code) noexcept { return getTable()[code]; }
+
+private:
+    static const std::array<float, maxCode + 1>& getTable() noexcept
+    {
+        static const auto table = []
+        {
+            std::array<float, maxCode + 1> t {};
+
+            for (int code = 1; code <= maxCode; ++code)
+                t[(size_t) code] = std::pow (10.0f, ((float) minDb + (float) (code - 1) * dbPerStep) / 20.0f);
+
+            return t;
+        }();
+
+        return table;
+    }
+};
+
+// 2 bytes per frame, ~0.0024 dB steps over -140..+20 dB.
+using LogLevelCodec16 = LogLevelCodec<juce::uint16, -140, 20>;
+
+// 1 byte per frame, ~0.4 dB steps over -90..+10 dB.
+using LogLevelCodec8 = LogLevelCodec<juce::uint8, -90, 10>;
+
+// The format used by the processor's history, chosen with SMOOTHSCOPE_HISTORY_BITS (32, 16 or 8).
+#ifndef SMOOTHSCOPE_HISTORY_BITS
+ #define SMOOTHSCOPE_HISTORY_BITS 32
+#endif
+
+#if SMOOTHSCOPE_HISTORY_BITS == 16
+ using HistoryCodec = LogLevelCodec16;
+#elif SMOOTHSCOPE_HISTORY_BITS == 8
+ using HistoryCodec = LogLevelCodec8;
+#else
+ using HistoryCodec = FloatLevelCodec;
+#endif
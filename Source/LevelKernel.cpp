@@ -0,0 +1,170 @@
+#include "LevelKernel.h"
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SMOOTHSCOPE_KERNEL_NEON 1
+#elif defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64)
+ #include <immintrin.h>
+ #define SMOOTHSCOPE_KERNEL_SSE 1
+ #if defined (__GNUC__) || defined (__clang__)
+  #define SMOOTHSCOPE_KERNEL_AVX2 1
+ #endif
+#endif
+
+namespace LevelKernel
+{
+
+void measureScalar (const float* data, int numSamples, BlockMeasurement& result) noexcept
+{
+    float sum = 0.0f;
+    float mn = result.min;
+    float mx = result.max;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float v = data[i];
+        sum += v * v;
+        mn = juce::jmin (mn, v);
+        mx = juce::jmax (mx, v);
+    }
+
+    result.sumSquares += (double) sum;
+    result.min = mn;
+    result.max = mx;
+}
+
+#if SMOOTHSCOPE_KERNEL_NEON
+
+static void measureNeon (const float* data, int numSamples, BlockMeasurement& result) noexcept
+{
+    float32x4_t sum0 = vdupq_n_f32 (0.0f), sum1 = vdupq_n_f32 (0.0f);
+    float32x4_t mn = vdupq_n_f32 (result.min), mx = vdupq_n_f32 (result.max);
+
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const float32x4_t a = vld1q_f32 (data + i);
+        const float32x4_t b = vld1q_f32 (data + i + 4);
+
+        sum0 = vmlaq_f32 (sum0, a, a);
+        sum1 = vmlaq_f32 (sum1, b, b);
+        mn = vminq_f32 (mn, vminq_f32 (a, b));
+        mx = vmaxq_f32 (mx, vmaxq_f32 (a, b));
+    }
+
+    const float32x4_t sum = vaddq_f32 (sum0, sum1);
+    result.sumSquares += (double) (vgetq_lane_f32 (sum, 0) + vgetq_lane_f32 (sum, 1)
+                                 + vgetq_lane_f32 (sum, 2) + vgetq_lane_f32 (sum, 3));
+
+    float lanes[4];
+    vst1q_f32 (lanes, mn);
+    result.min = juce::jmin (juce::jmin (lanes[0], lanes[1]), juce::jmin (lanes[2], lanes[3]));
+    vst1q_f32 (lanes, mx);
+    result.max = juce::jmax (juce::jmax (lanes[0], lanes[1]), juce::jmax (lanes[2], lanes[3]));
+
+    measureScalar (data + i, numSamples - i, result);
+}
+
+#endif
+
+#if SMOOTHSCOPE_KERNEL_SSE
+
+static float horizontalSum (__m128 v) noexcept
+{
+    v = _mm_add_ps (v, _mm_movehl_ps (v, v));
+    v = _mm_add_ss (v, _mm_shuffle_ps (v, v, 1));
+    return _mm_cvtss_f32 (v);
+}
+
+static float horizontalMin (__m128 v) noexcept
+{
+    v = _mm_min_ps (v, _mm_movehl_ps (v, v));
+    v = _mm_min_ss (v, _mm_shuffle_ps (v, v, 1));
+    return _mm_cvtss_f32 (v);
+}
+
+static float horizontalMax (__m128 v) noexcept
+{
+    v = _mm_max_ps (v, _mm_movehl_ps (v, v));
+    v = _mm_max_ss (v, _mm_shuffle_ps (v, v, 1));
+    return _mm_cvtss_f32 (v);
+}
+
+static void measureSSE (const float* data, int numSamples, BlockMeasurement& result) noexcept
+{
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    __m128 mn = _mm_set1_ps (result.min), mx = _mm_set1_ps (result.max);
+
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const __m128 a = _mm_loadu_ps (data + i);
+        const __m128 b = _mm_loadu_ps (data + i + 4);
+
+        sum0 = _mm_add_ps (sum0, _mm_mul_ps (a, a));
+        sum1 = _mm_add_ps (sum1, _mm_mul_ps (b, b));
+        mn = _mm_min_ps (mn, _mm_min_ps (a, b));
+        mx = _mm_max_ps (mx, _mm_max_ps (a, b));
+    }
+
+    result.sumSquares += (double) horizontalSum (_mm_add_ps (sum0, sum1));
+    result.min = horizontalMin (mn);
+    result.max = horizontalMax (mx);
+
+    measureScalar (data + i, numSamples - i, result);
+}
+
+#endif
+
+#if SMOOTHSCOPE_KERNEL_AVX2
+
+__attribute__ ((target ("avx2,fma")))
+static void measureAVX2 (const float* data, int numSamples, BlockMeasurement& result) noexcept
+{
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    __m256 mn = _mm256_set1_ps (result.min), mx = _mm256_set1_ps (result.max);
+
+    int i = 0;
+
+    for (; i + 16 <= numSamples; i += 16)
+    {
+        const __m256 a = _mm256_loadu_ps (data + i);
+        const __m256 b = _mm256_loadu_ps (data + i + 8);
+
+        sum0 = _mm256_fmadd_ps (a, a, sum0);
+        sum1 = _mm256_fmadd_ps (b, b, sum1);
+        mn = _mm256_min_ps (mn, _mm256_min_ps (a, b));
+        mx = _mm256_max_ps (mx, _mm256_max_ps (a, b));
+    }
+
+    const __m256 sum = _mm256_add_ps (sum0, sum1);
+    result.sumSquares += (double) horizontalSum (_mm_add_ps (_mm256_castps256_ps128 (sum), _mm256_extractf128_ps (sum, 1)));
+    result.min = horizontalMin (_mm_min_ps (_mm256_castps256_ps128 (mn), _mm256_extractf128_ps (mn, 1)));
+    result.max = horizontalMax (_mm_max_ps (_mm256_castps256_ps128 (mx), _mm256_extractf128_ps (mx, 1)));
+
+    measureSSE (data + i, numSamples - i, result);
+}
+
+#endif
+
+void measure (const float* data, int numSamples, BlockMeasurement& result) noexcept
+{
+   #if SMOOTHSCOPE_KERNEL_NEON
+    measureNeon (data, numSamples, result);
+   #elif SMOOTHSCOPE_KERNEL_AVX2
+    static const bool useAVX2 = juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+
+    if (useAVX2)
+        measureAVX2 (data, numSamples, result);
+    else
+        measureSSE (data, numSamples, result);
+   #elif SMOOTHSCOPE_KERNEL_SSE
+    measureSSE (data, numSamples, result);
+   #else
+    measureScalar (data, numSamples, result);
+   #endif
+}
+
+} // namespace LevelKernel
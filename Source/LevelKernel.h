@@ -0,0 +1,26 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Running per-block measurement filled in by the kernel.
+struct BlockMeasurement
+{
+    double sumSquares = 0.0;
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+
+    float getPeak() const noexcept { return min > max ? 0.0f : juce::jmax (std::abs (min), std::abs (max)); }
+};
+
+// Fused one-pass measurement kernel: sum-of-squares, minimum and maximum of a
+// block of samples, folded into an existing BlockMeasurement.
+//
+// Uses NEON on arm64 and SSE2 on x86_64, switching to AVX2 at runtime when the
+// CPU supports it, so both slices of the universal binary get a vector path.
+namespace LevelKernel
+{
+    void measure (const float* data, int numSamples, BlockMeasurement& result) noexcept;
+
+    // Reference implementation, also used for the tails of the vector paths.
+    void measureScalar (const float* data, int numSamples, BlockMeasurement& result) noexcept;
+}
@@ -0,0 +1,108 @@
+#include "LevelPublisher.h"
+#include "LevelAnalyser.h"
+
+LevelPublisher::LevelPublisher()
+    : juce::Thread ("SmoothScope Publisher"),
+      streamId ((juce::uint32) juce::Random::getSystemRandom().nextInt()),
+      queuedRms ((size_t) queueFrames), queuedPeak ((size_t) queueFrames),
+      streamName (juce::SystemStats::getComputerName())
+{
+}
+
+LevelPublisher::~LevelPublisher()
+{
+    stopThread (1000);
+}
+
+void LevelPublisher::setEnabled (bool shouldBeEnabled)
+{
+    // Check and switch as one step, so two callers cannot leave the flag and the
+    // thread disagreeing
+    const juce::ScopedLock sl (enableLock);
+
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    enabled.store (shouldBeEnabled, std::memory_order_relaxed);
+
+    if (shouldBeEnabled) startThread (juce::Thread::Priority::low);
+    else                 stopThread (1000);
+}
+
+void LevelPublisher::setStreamName (const juce::String& newName)
+{
+    const juce::ScopedLock sl (queueLock);
+    streamName = newName;
+}
+
+void LevelPublisher::append (const LevelFrame& frame) noexcept
+{
+    // Frame numbers carry on across a pause, so a viewer keeps one timeline and sees the gap
+    const auto frameNumber = nextFrame++;
+
+    if (! isEnabled())
+        return;
+
+    const juce::ScopedLock sl (queueLock);
+
+    // Nobody has sent for a long time: give up on the backlog rather than block or grow
+    if (numQueued == queueFrames)
+        numQueued = 0;
+
+    // After a pause the queue has been sent already, so it starts again at this frame
+    if (numQueued > 0 && queueFirstFrame + numQueued != frameNumber)
+        numQueued = 0;
+
+    if (numQueued == 0)
+        queueFirstFrame = frameNumber;
+
+    queuedRms[(size_t) numQueued] = frame.rms;
+    queuedPeak[(size_t) numQueued] = frame.peak;
+    ++numQueued;
+}
+
+void LevelPublisher::run()
+{
+    // Unbound: the system picks an ephemeral source port on the first write
+    juce::DatagramSocket socket;
+    socket.setMulticastLoopbackEnabled (true);
+
+    std::vector<float> rms ((size_t) queueFrames), peak ((size_t) queueFrames);
+    juce::MemoryOutputStream packet (2048);
+
+    while (! threadShouldExit())
+    {
+        wait (sendIntervalMs);
+
+        int count;
+        juce::int64 firstFrame;
+        juce::String name;
+
+        {
+            const juce::ScopedLock sl (queueLock);
+            count = numQueued;
+            firstFrame = queueFirstFrame;
+            name = streamName;
+
+            std::copy (queuedRms.begin(), queuedRms.begin() + count, rms.begin());
+            std::copy (queuedPeak.begin(), queuedPeak.begin() + count, peak.begin());
+            numQueued = 0;
+        }
+
+        for (int offset = 0; offset < count; offset += LevelBroadcast::maxFramesPerPacket)
+            send (socket, packet, name, firstFrame + offset, rms.data() + offset, peak.data() + offset,
+                  juce::jmin (LevelBroadcast::maxFramesPerPacket, count - offset));
+    }
+}
+
+void LevelPublisher::send (juce::DatagramSocket& socket, juce::MemoryOutputStream& packet, const juce::String& name,
+                           juce::int64 firstFrame, const float* rms, const float* peak, int numFrames)
+{
+    packet.reset();
+    LevelBroadcast::write (packet, streamId, name, frameRate.load (std::memory_order_relaxed),
+                           firstFrame, rms, peak, numFrames);
+
+    // Best effort: a datagram that cannot be sent is simply a gap for the viewers
+    socket.write (LevelBroadcast::multicastGroup, LevelBroadcast::defaultPort,
+                  packet.getData(), (int) packet.getDataSize());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelBroadcast.h"
+
+struct LevelFrame;
+
+// Optional broadcast of the mix levels to SmoothScopeViewer over UDP multicast.
+//
+// The history thread hands over every frame it drains from the FIFO (append()),
+// so the audio thread is not involved beyond the ring it already writes. This
+// thread wakes every sendIntervalMs, takes what has queued up and sends it in
+// LevelBroadcast packets. Frames are numbered from the first one handed over,
+// whether or not publishing is on, so a pause shows up as a gap in the numbers;
+// so does a network stall longer than the queue holds, whose oldest frames are dropped.
+//
+// Local viewers receive the same multicast via loopback, so one transport
+// serves both the same machine and the rest of the network.
+class LevelPublisher : private juce::Thread
+{
+public:
+    LevelPublisher();
+    ~LevelPublisher() override;
+
+    // Any thread: hosts restore the state (and with it this switch) wherever they like,
+    // so the flag and the thread are switched together under one lock.
+    void setEnabled (bool shouldBeEnabled);
+    bool isEnabled() const noexcept { return enabled.load (std::memory_order_relaxed); }
+
+    // Shown by the viewer, e.g. the host's track name. Any thread.
+    void setStreamName (const juce::String& newName);
+
+    // Hop rate of the frames that will be appended. Any thread.
+    void setFrameRate (double newFrameRate) noexcept { frameRate.store ((float) newFrameRate, std::memory_order_relaxed); }
+
+    // History thread: queues the frame for the next packet. While disabled the frame is
+    // only counted, so numbering carries on across a pause and viewers see the gap.
+    void append (const LevelFrame& frame) noexcept;
+
+private:
+    void run() override;
+    void send (juce::DatagramSocket& socket, juce::MemoryOutputStream& packet, const juce::String& name,
+               juce::int64 firstFrame, const float* rms, const float* peak, int numFrames);
+
+    // ~40 s at the 10 ms hop; preallocated so append() never allocates
+    static constexpr int queueFrames = 4096;
+    static constexpr int sendIntervalMs = 50;
+
+    juce::CriticalSection enableLock;
+    std::atomic<bool> enabled { false };
+    std::atomic<float> frameRate { 100.0f };
+    const juce::uint32 streamId;
+
+    juce::CriticalSection queueLock;
+    std::vector<float> queuedRms, queuedPeak;
+    int numQueued = 0;
+    juce::int64 queueFirstFrame = 0; // frame number of queued*[0]
+    juce::int64 nextFrame = 0; // history thread only
+    juce::String streamName;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelPublisher)
+};
@@ -0,0 +1,28 @@
+#include "LodPlanner.h"
+
+LodPlan LodPlanner::plan (juce::Rectangle<int> clip, int width, float zoomX) noexcept
+{
+    LodPlan p;
+
+    const int w = juce::jmax (0, width);
+    const int clipLeft  = juce::jlimit (0, w, clip.getX());
+    const int clipRight = juce::jlimit (0, w, clip.getRight());
+
+    p.useRaw = (zoomX >= rawZoom);
+
+    // Column c sits at x = w - c
+    p.firstColumn = juce::jmax (0, w - clipRight - 1);
+    p.endColumn   = juce::jmax (p.firstColumn, juce::jmin (w + 1, w - clipLeft + 2));
+
+    // Sample s (ago) sits at x = w - s * zoomX
+    const double samplesPerPixel = 1.0 / (double) zoomX;
+    const auto lastSample = (juce::int64) std::ceil ((double) (w - clipLeft) * samplesPerPixel) + 2;
+    p.firstSample = juce::jmax ((juce::int64) 0, (juce::int64) std::floor ((double) (w - clipRight) * samplesPerPixel) - 1);
+    p.numSamples  = juce::jmax ((juce::int64) 0, lastSample - p.firstSample);
+
+    if (zoomX >= detailZoom)        p.detail = 1.0f;
+    else if (zoomX <= overviewZoom) p.detail = 0.0f;
+    else                            p.detail = std::log (zoomX / overviewZoom) / std::log (detailZoom / overviewZoom);
+
+    return p;
+}
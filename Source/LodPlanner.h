@@ -0,0 +1,40 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// What one paint has to draw, worked out once and shared by every zone.
+//
+// Columns are counted from the right edge (column 0 is the newest pixel), raw
+// samples in "samples ago". Both ranges only cover the clip region (plus one
+// unit of slack on either side so strokes join up), so a partial repaint or
+// an overlay update only pays for what is actually visible.
+struct LodPlan
+{
+    bool useRaw = false;            // ZONE 1: interpolate raw samples instead of reducing columns
+
+    int firstColumn = 0;            // envelope columns [firstColumn, endColumn)
+    int endColumn = 0;
+
+    juce::int64 firstSample = 0;    // raw samples [firstSample, firstSample + numSamples)
+    juce::int64 numSamples = 0;
+
+    float detail = 1.0f;            // 0 = overview ... 1 = mid range, blended over a zoom band
+
+    // Thickness enforcement and fill fade in with detail, so there is no jump between zones
+    float getMinThickness() const noexcept { return 1.5f * detail; }
+    float getFillAlpha() const noexcept    { return 0.5f + 0.1f * detail; }
+};
+
+struct LodPlanner
+{
+    // At and above this zoom each sample gets at least one pixel
+    static constexpr float rawZoom = 1.0f;
+
+    // Detail blends (logarithmically) from overview to mid range across this zoom band
+    static constexpr float overviewZoom = 0.01f;
+    static constexpr float detailZoom = 0.05f;
+
+    // The pyramid level is not part of the plan: every column query already descends
+    // to the coarsest level its range allows (see PyramidLayout::reduce).
+    static LodPlan plan (juce::Rectangle<int> clip, int width, float zoomX) noexcept;
+};
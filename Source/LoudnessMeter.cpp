@@ -0,0 +1,96 @@
+#include "LoudnessMeter.h"
+
+void LoudnessMeter::prepare (double newFrameRate)
+{
+    frameRate = newFrameRate;
+
+    // 100 ms gating step; the windows are whole steps so the 75% overlap is exact
+    stepHops = juce::jmax (1, juce::roundToInt (0.1 * frameRate));
+    momentaryHops = 4 * stepHops;
+    shortTermHops = 30 * stepHops;
+
+    hopEnergies.assign ((size_t) shortTermHops, 0.0f);
+    histogram.assign ((size_t) numBins, Bin());
+
+    reset();
+}
+
+void LoudnessMeter::reset() noexcept
+{
+    std::fill (hopEnergies.begin(), hopEnergies.end(), 0.0f);
+    std::fill (histogram.begin(), histogram.end(), Bin());
+
+    ringPos = 0;
+    numPushed = 0;
+    momentarySum = shortTermSum = 0.0;
+    gatedCount = 0;
+    gatedEnergy = 0.0;
+    integratedLufs = -std::numeric_limits<float>::infinity();
+}
+
+void LoudnessMeter::push (float hopEnergy) noexcept
+{
+    if (hopEnergies.empty())
+        return;
+
+    const auto size = (int) hopEnergies.size();
+
+    // The ring is exactly shortTermHops long, so the slot about to be overwritten leaves
+    // the short-term window, and the one momentaryHops back leaves the momentary window.
+    const int momentaryOut = (ringPos + size - momentaryHops) % size;
+
+    shortTermSum += (double) hopEnergy - (double) hopEnergies[(size_t) ringPos];
+    momentarySum += (double) hopEnergy - (double) hopEnergies[(size_t) momentaryOut];
+
+    hopEnergies[(size_t) ringPos] = hopEnergy;
+    ringPos = (ringPos + 1) % size;
+    ++numPushed;
+
+    if (ringPos == 0)
+    {
+        // Once per lap: start over from the stored values, dropping accumulated rounding
+        shortTermSum = momentarySum = 0.0;
+
+        for (int i = 0; i < size; ++i)
+            shortTermSum += (double) hopEnergies[(size_t) i];
+
+        for (int i = size - momentaryHops; i < size; ++i)
+            momentarySum += (double) hopEnergies[(size_t) i];
+    }
+
+    // A gating block ends on every 100 ms step once the first full 400 ms are in
+    if (numPushed >= momentaryHops && numPushed % stepHops == 0)
+        addGatingBlock (getMomentaryEnergy());
+}
+
+void LoudnessMeter::addGatingBlock (double energy) noexcept
+{
+    const float lufs = energyToLufs (energy);
+
+    if (! (lufs > absoluteGateLufs))
+        return;
+
+    const auto bin = juce::jlimit (0, numBins - 1, (int) ((lufs - absoluteGateLufs) / binWidthLu));
+    histogram[(size_t) bin].count++;
+    histogram[(size_t) bin].energy += energy;
+
+    gatedCount++;
+    gatedEnergy += energy;
+
+    // Relative gate: 10 LU below the mean of everything above the absolute gate.
+    // Blocks in the bin the threshold falls into are counted with it.
+    const float threshold = energyToLufs (gatedEnergy / (double) gatedCount) + relativeGateLu;
+    const auto firstBin = juce::jlimit (0, numBins - 1, (int) ((threshold - absoluteGateLufs) / binWidthLu));
+
+    juce::int64 count = 0;
+    double sum = 0.0;
+
+    for (int b = firstBin; b < numBins; ++b)
+    {
+        count += histogram[(size_t) b].count;
+        sum += histogram[(size_t) b].energy;
+    }
+
+    if (count > 0)
+        integratedLufs = energyToLufs (sum / (double) count);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// ITU-R BS.1770-4 / EBU R 128 loudness from the per-hop K-weighted energies the
+// LevelAnalyser sends through the FIFO (LevelFrame::loudnessEnergy).
+//
+// Every window is a whole number of 100 ms sub-blocks of hops: momentary is 4 of
+// them (400 ms), short-term 30 (3 s). Both are running sums over a ring of hop
+// energies, one add and one subtract per hop, re-summed once per lap of the ring
+// so rounding cannot build up.
+//
+// Integrated loudness gates the 400 ms momentary blocks at every 100 ms step (75%
+// overlap). Instead of keeping every block, they are binned by loudness into a
+// fixed histogram that also holds each bin's energy sum, so the relative gate is
+// one walk over the bins however long the programme runs. The gate is resolved to
+// the bin width (0.1 LU); the energies themselves are exact.
+//
+// Used on the history thread only.
+class LoudnessMeter
+{
+public:
+    static constexpr float absoluteGateLufs = -70.0f;
+    static constexpr float relativeGateLu = -10.0f;
+
+    LoudnessMeter() = default;
+
+    // Allocates; frameRate is the hop rate of the energies that will be pushed.
+    void prepare (double frameRate);
+    void reset() noexcept;
+
+    double getFrameRate() const noexcept { return frameRate; }
+
+    void push (float hopEnergy) noexcept;
+
+    // Mean K-weighted energy of the last 400 ms / 3 s, counting hops before the first as silence
+    double getMomentaryEnergy() const noexcept { return momentarySum / (double) momentaryHops; }
+    double getShortTermEnergy() const noexcept { return shortTermSum / (double) shortTermHops; }
+
+    // Gated integrated loudness since reset(); -inf until a block has passed the absolute gate
+    float getIntegratedLufs() const noexcept { return integratedLufs; }
+
+    // BS.1770 loudness of a mean K-weighted energy
+    static float energyToLufs (double energy) noexcept
+    {
+        return energy > 0.0 ? (float) (-0.691 + 10.0 * std::log10 (energy)) : -std::numeric_limits<float>::infinity();
+    }
+
+private:
+    void addGatingBlock (double energy) noexcept;
+
+    static constexpr float binWidthLu = 0.1f;
+    static constexpr int numBins = 1000; // -70 .. +30 LUFS
+
+    struct Bin
+    {
+        juce::int64 count = 0;
+        double energy = 0.0;
+    };
+
+    double frameRate = 0.0;
+    int stepHops = 1, momentaryHops = 4, shortTermHops = 30;
+
+    std::vector<float> hopEnergies; // ring of the last shortTermHops energies
+    int ringPos = 0;
+    juce::int64 numPushed = 0;
+    double momentarySum = 0.0, shortTermSum = 0.0;
+
+    std::vector<Bin> histogram;
+    juce::int64 gatedCount = 0; // blocks above the absolute gate
+    double gatedEnergy = 0.0;
+    float integratedLufs = -std::numeric_limits<float>::infinity();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessMeter)
+};
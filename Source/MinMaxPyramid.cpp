@@ -0,0 +1,236 @@
+#include "MinMaxPyramid.h"
+
+template <typename Codec>
+MinMaxPyramid<Codec>::MinMaxPyramid (int capacityToUse)
+    : capacity (capacityToUse), raw (capacityToUse)
+{
+    // Storage starts out zeroed (see CircularHistory), which has to decode as silence
+    jassert (Codec::encode (0.0f) == 0);
+
+    // Keep adding coarser levels until the top one only has a few entries left.
+    for (int size = capacity >> branchShift; size >= branchFactor; size >>= branchShift)
+        levels.emplace_back (size);
+}
+
+template <typename Codec>
+void MinMaxPyramid<Codec>::clear() noexcept
+{
+    raw.clear();
+
+    for (auto& level : levels)
+    {
+        level.entries.clear();
+        level.count = 0;
+    }
+
+    numWritten = 0;
+}
+
+namespace
+{
+    // Splits [0, numElements) into chunks and runs body (begin, end) on each one
+    void forEachChunk (juce::int64 numElements, juce::int64 chunkSize, const ParallelFor& parallelFor,
+                       const std::function<void (juce::int64, juce::int64)>& body)
+    {
+        const auto numChunks = (int) ((numElements + chunkSize - 1) / chunkSize);
+
+        auto runChunk = [&] (int chunk)
+        {
+            const auto begin = (juce::int64) chunk * chunkSize;
+            body (begin, juce::jmin (numElements, begin + chunkSize));
+        };
+
+        if (parallelFor == nullptr || numChunks <= 1)
+        {
+            for (int chunk = 0; chunk < numChunks; ++chunk)
+                runChunk (chunk);
+        }
+        else
+        {
+            parallelFor (numChunks, runChunk);
+        }
+    }
+
+    // dest[b] = Min/Max of src[b * 4 .. b * 4 + 3]. Branch-free over contiguous
+    // arrays, so the compiler can vectorise it.
+    template <typename Stored>
+    void reduceBlocks (const Stored* src, BasicMinMax<Stored>* dest, juce::int64 begin, juce::int64 end) noexcept
+    {
+        for (auto b = begin; b < end; ++b)
+        {
+            const Stored* p = src + b * PyramidLayout::branchFactor;
+            dest[b] = { juce::jmin (juce::jmin (p[0], p[1]), juce::jmin (p[2], p[3])),
+                        juce::jmax (juce::jmax (p[0], p[1]), juce::jmax (p[2], p[3])) };
+        }
+    }
+
+    template <typename Stored>
+    void reduceBlocks (const BasicMinMax<Stored>* src, BasicMinMax<Stored>* dest, juce::int64 begin, juce::int64 end) noexcept
+    {
+        for (auto b = begin; b < end; ++b)
+        {
+            const auto* p = src + b * PyramidLayout::branchFactor;
+            dest[b] = { juce::jmin (juce::jmin (p[0].min, p[1].min), juce::jmin (p[2].min, p[3].min)),
+                        juce::jmax (juce::jmax (p[0].max, p[1].max), juce::jmax (p[2].max, p[3].max)) };
+        }
+    }
+
+    // Min/Max of a short run of raw codes or entries, for the partially filled accumulators
+    template <typename Stored>
+    BasicMinMax<Stored> reduceRun (const Stored* src, int count) noexcept
+    {
+        BasicMinMax<Stored> r { src[0], src[0] };
+        for (int i = 1; i < count; ++i) { r.min = juce::jmin (r.min, src[i]); r.max = juce::jmax (r.max, src[i]); }
+        return r;
+    }
+
+    template <typename Stored>
+    BasicMinMax<Stored> reduceRun (const BasicMinMax<Stored>* src, int count) noexcept
+    {
+        BasicMinMax<Stored> r = src[0];
+        for (int i = 1; i < count; ++i) { r.min = juce::jmin (r.min, src[i].min); r.max = juce::jmax (r.max, src[i].max); }
+        return r;
+    }
+}
+
+template <typename Codec>
+void MinMaxPyramid<Codec>::assign (const float* values, juce::int64 numValues, const ParallelFor& parallelFor)
+{
+    clear();
+
+    // Only the newest capacity values fit. Restarting the count at 0 keeps every
+    // level block-aligned, and makes each ring contiguous from its first slot.
+    const auto n = juce::jmin (numValues, (juce::int64) capacity);
+    const float* source = values + (numValues - n);
+
+    auto* codes = raw.getFillPointer();
+    forEachChunk (n, assignChunkSize, parallelFor, [&] (juce::int64 begin, juce::int64 end)
+    {
+        for (auto i = begin; i < end; ++i)
+            codes[i] = Codec::encode (source[i]);
+    });
+
+    raw.setNumWritten (n);
+    numWritten = n;
+
+    // Build level by level; blocks within a level are independent
+    juce::int64 numBelow = n; // complete blocks (or samples) on the level below
+
+    for (size_t l = 0; l < levels.size(); ++l)
+    {
+        auto& level = levels[l];
+        auto* dest = level.entries.getFillPointer();
+        const auto numBlocks = numBelow >> branchShift;
+
+        forEachChunk (numBlocks, assignChunkSize, parallelFor, [&] (juce::int64 begin, juce::int64 end)
+        {
+            if (l == 0) reduceBlocks (codes, dest, begin, end);
+            else        reduceBlocks (levels[l - 1].entries.getFillPointer(), dest, begin, end);
+        });
+
+        level.entries.setNumWritten (numBlocks);
+
+        // The trailing, incomplete block continues in the accumulator exactly as push() would
+        level.count = (int) (numBelow & (branchFactor - 1));
+
+        if (level.count > 0)
+            level.accumulator = (l == 0) ? reduceRun (codes + numBlocks * branchFactor, level.count)
+                                         : reduceRun (levels[l - 1].entries.getFillPointer() + numBlocks * branchFactor, level.count);
+
+        numBelow = numBlocks;
+    }
+}
+
+template <typename Codec>
+size_t MinMaxPyramid<Codec>::getMemoryUsage() const noexcept
+{
+    size_t bytes = (size_t) raw.getCapacity() * sizeof (Stored);
+
+    for (const auto& level : levels)
+        bytes += (size_t) level.entries.getCapacity() * sizeof (StoredMinMax);
+
+    return bytes;
+}
+
+template <typename Codec>
+void MinMaxPyramid<Codec>::push (float value) noexcept
+{
+    const Stored code = Codec::encode (value);
+
+    raw.push (code);
+    ++numWritten;
+
+    // Cascade the completed block upwards. Each level only fires once every
+    // branchFactor pushes of the level below, so this is amortised O(1).
+    StoredMinMax carry { code, code };
+
+    for (auto& level : levels)
+    {
+        if (level.count == 0)
+        {
+            level.accumulator = carry;
+        }
+        else
+        {
+            if (carry.min < level.accumulator.min) level.accumulator.min = carry.min;
+            if (carry.max > level.accumulator.max) level.accumulator.max = carry.max;
+        }
+
+        if (++level.count < branchFactor)
+            break;
+
+        level.entries.push (level.accumulator);
+        level.count = 0;
+        carry = level.accumulator;
+    }
+}
+
+template <typename Codec>
+float MinMaxPyramid<Codec>::getSample (juce::int64 samplesAgo) const noexcept
+{
+    if (samplesAgo < 0 || samplesAgo >= getNumAvailable())
+        return 0.0f;
+
+    return Codec::decode (raw[numWritten - 1 - samplesAgo]);
+}
+
+template <typename Codec>
+int MinMaxPyramid<Codec>::readRaw (juce::int64 samplesAgo, juce::int64 numSamples, float* dest) const noexcept
+{
+    const auto spans = getRawSpans (samplesAgo, numSamples);
+
+    for (int i = 0; i < spans.size1; ++i) dest[i] = Codec::decode (spans.data1[i]);
+    for (int i = 0; i < spans.size2; ++i) dest[spans.size1 + i] = Codec::decode (spans.data2[i]);
+
+    return spans.getTotalSize();
+}
+
+template <typename Codec>
+bool MinMaxPyramid<Codec>::getRange (juce::int64 samplesAgo, juce::int64 numSamples, MinMax& result) const noexcept
+{
+    // Convert to absolute sample positions [lo, hi)
+    return getRangeAbsolute (numWritten - samplesAgo - numSamples,
+                             numWritten - juce::jmax ((juce::int64) 0, samplesAgo),
+                             result);
+}
+
+template <typename Codec>
+bool MinMaxPyramid<Codec>::getRangeAbsolute (juce::int64 lo, juce::int64 hi, MinMax& result) const noexcept
+{
+    lo = juce::jmax (lo, numWritten - getNumAvailable());
+    hi = juce::jmin (hi, numWritten);
+
+    if (lo >= hi)
+        return false;
+
+    const auto codes = reduce (lo, hi, (int) levels.size(),
+                               [this] (juce::int64 i) { return raw[i]; },
+                               [this] (int l, juce::int64 i) { return levels[(size_t) l].entries[i]; });
+
+    result = { Codec::decode (codes.min), Codec::decode (codes.max) };
+    return true;
+}
+
+template class MinMaxPyramid<FloatLevelCodec>;
+template class MinMaxPyramid<LogLevelCodec16>;
+template class MinMaxPyramid<LogLevelCodec8>;
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularHistory.h"
+#include "LevelCodec.h"
+
+// Simple struct to hold both peak and valley for a time range
+template <typename T>
+struct BasicMinMax
+{
+    T min;
+    T max;
+};
+
+using MinMax = BasicMinMax<float>;
+
+// Runs task (i) for i in [0, numTasks), possibly concurrently, and returns when all are
+// done (e.g. RenderWorkerPool::parallelFor). An empty function means "run serially".
+using ParallelFor = std::function<void (int numTasks, const std::function<void (int)>& task)>;
+
+// Layout constants and the range reduction shared by every power-of-four
+// pyramid, whether it lives in RAM (MinMaxPyramid) or on disk (PersistentHistory).
+struct PyramidLayout
+{
+    static constexpr int branchFactor = 4;
+    static constexpr int branchShift = 2; // log2 (branchFactor)
+
+    // The O(log N) reduction: raw (i) returns the sample at absolute position i, level (l, i)
+    // the BasicMinMax of block i on level l, where level l holds blocks of branchFactor^(l + 1)
+    // samples. Requires lo < hi, and every block touched must be complete.
+    template <typename RawAccessor, typename LevelAccessor>
+    static auto reduce (juce::int64 lo, juce::int64 hi, int numLevels, RawAccessor&& raw, LevelAccessor&& level) noexcept
+    {
+        using Value = std::decay_t<decltype (raw (lo))>;
+
+        Value minV = std::numeric_limits<Value>::max();
+        Value maxV = std::numeric_limits<Value>::lowest();
+
+        auto fold = [&] (Value mn, Value mx)
+        {
+            if (mn < minV) minV = mn;
+            if (mx > maxV) maxV = mx;
+        };
+
+        // Level "-1" is the raw data: peel off the unaligned head and tail until both
+        // ends sit on a block boundary, then continue one level up.
+        constexpr juce::int64 alignMask = branchFactor - 1;
+
+        while (lo < hi && (lo & alignMask) != 0) { const Value v = raw (lo++); fold (v, v); }
+        while (lo < hi && (hi & alignMask) != 0) { const Value v = raw (--hi); fold (v, v); }
+
+        for (int l = 0; l < numLevels && lo < hi; ++l)
+        {
+            lo >>= branchShift;
+            hi >>= branchShift;
+
+            const bool isTop = (l + 1 == numLevels);
+
+            // On the top level there is nothing coarser to defer to, so take everything.
+            while (lo < hi && (isTop || (lo & alignMask) != 0)) { const auto e = level (l, lo++); fold (e.min, e.max); }
+            while (lo < hi && (hi & alignMask) != 0)            { const auto e = level (l, --hi); fold (e.min, e.max); }
+        }
+
+        // Tiny layouts may have no levels at all
+        while (lo < hi && numLevels == 0) { const Value v = raw (lo++); fold (v, v); }
+
+        return BasicMinMax<Value> { minV, maxV };
+    }
+};
+
+// Circular raw history plus a power-of-four Min/Max pyramid built on top of it.
+//
+// Level 0 stores 4-sample blocks, level 1 stores 16-sample blocks, and so on
+// until the top level holds only a handful of entries. Every level spans the
+// same stretch of time as the raw ring, so any range that is still in the raw
+// history can be answered from the pyramid.
+//
+// Values are kept in the Codec's storage format (see LevelCodec.h). Because
+// codecs are monotonic, the pyramid reduces the stored codes directly and
+// only decodes results on the way out.
+//
+// push() is amortised O(1); getRange() touches at most 2 * (branchFactor - 1)
+// entries per level, i.e. O(log N) for a range of N samples.
+template <typename Codec = FloatLevelCodec>
+class MinMaxPyramid : public PyramidLayout
+{
+public:
+    using Stored = typename Codec::Stored;
+
+    // capacity must be a power of two (and of four).
+    explicit MinMaxPyramid (int capacity);
+
+    void push (float value) noexcept;
+    void clear() noexcept;
+
+    // Replaces the contents with the newest getCapacity() of values [0, numValues), oldest
+    // first, counting positions from 0 again. Encoding and every level are built as
+    // data-parallel reductions over chunks, split across parallelFor if one is given.
+    void assign (const float* values, juce::int64 numValues, const ParallelFor& parallelFor = {});
+
+    int getCapacity() const noexcept { return capacity; }
+    int getNumLevels() const noexcept { return (int) levels.size(); }
+
+    // Bytes of storage held for samples and levels.
+    size_t getMemoryUsage() const noexcept;
+
+    // Total number of samples ever pushed (monotonic, does not wrap).
+    juce::int64 getNumWritten() const noexcept { return numWritten; }
+
+    // Number of samples that can still be read back.
+    juce::int64 getNumAvailable() const noexcept { return raw.getNumAvailable(); }
+
+    // Raw sample, 0 = newest. Samples that were never written (or already overwritten) read as silence.
+    float getSample (juce::int64 samplesAgo) const noexcept;
+
+    // The raw samples [samplesAgo, samplesAgo + numSamples) in their stored format, as at most two
+    // contiguous spans in chronological order (oldest first), clipped to the recorded history.
+    typename CircularHistory<Stored>::Spans getRawSpans (juce::int64 samplesAgo, juce::int64 numSamples) const noexcept
+    {
+        return raw.getSpans (numWritten - samplesAgo - numSamples, numWritten - samplesAgo);
+    }
+
+    // Decodes the same window into dest (oldest first) and returns the number of samples written.
+    int readRaw (juce::int64 samplesAgo, juce::int64 numSamples, float* dest) const noexcept;
+
+    // Min/Max over the range [samplesAgo, samplesAgo + numSamples), 0 = newest.
+    // The range is clipped to the recorded history; returns false if nothing is left.
+    bool getRange (juce::int64 samplesAgo, juce::int64 numSamples, MinMax& result) const noexcept;
+
+    // Same as getRange(), but in absolute sample positions [start, end) as counted by getNumWritten().
+    bool getRangeAbsolute (juce::int64 start, juce::int64 end, MinMax& result) const noexcept;
+
+private:
+    using StoredMinMax = BasicMinMax<Stored>;
+
+    // Elements per parallel task in assign()
+    static constexpr juce::int64 assignChunkSize = 1 << 16;
+
+    struct Level
+    {
+        explicit Level (int size) : entries (size) {}
+
+        CircularHistory<StoredMinMax> entries; // one entry per completed block
+
+        // Running Min/Max of the block currently being filled
+        StoredMinMax accumulator { 0, 0 };
+        int count = 0;
+    };
+
+    const int capacity;
+
+    CircularHistory<Stored> raw;
+    std::vector<Level> levels; // levels[l] holds blocks of branchFactor^(l + 1) samples
+
+    juce::int64 numWritten = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MinMaxPyramid)
+};
+
+// Implemented for these codecs in MinMaxPyramid.cpp
+extern template class MinMaxPyramid<FloatLevelCodec>;
+extern template class MinMaxPyramid<LogLevelCodec16>;
+extern template class MinMaxPyramid<LogLevelCodec8>;
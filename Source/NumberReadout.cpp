@@ -0,0 +1,52 @@
+#include "NumberReadout.h"
+
+float NumberReadout::getAdvance (const juce::GlyphArrangement& glyphs)
+{
+    // Laid out from x = 0, so the right edge including trailing whitespace is the advance
+    return glyphs.getNumGlyphs() > 0 ? glyphs.getBoundingBox (0, -1, true).getRight() : 0.0f;
+}
+
+void NumberReadout::prepare (const juce::Font& font, const juce::String& label)
+{
+    // Laid out on the baseline of a line whose top is at 0
+    labelGlyphs.clear();
+    labelGlyphs.addLineOfText (font, label, 0.0f, font.getAscent());
+    labelWidth = getAdvance (labelGlyphs);
+
+    for (int d = 0; d < 10; ++d)
+    {
+        digitGlyphs[d].clear();
+        digitGlyphs[d].addLineOfText (font, juce::String::charToString ((juce::juce_wchar) ('0' + d)), 0.0f, font.getAscent());
+        digitWidths[d] = getAdvance (digitGlyphs[d]);
+    }
+
+    prepared = true;
+}
+
+void NumberReadout::draw (juce::Graphics& g, juce::int64 value, float right, float top) const
+{
+    if (! prepared)
+        return;
+
+    // Digits least significant first; 19 is enough for any int64
+    int digits[19];
+    int numDigits = 0;
+    float width = labelWidth;
+
+    for (auto v = juce::jmax ((juce::int64) 0, value); numDigits == 0 || v > 0; v /= 10)
+    {
+        digits[numDigits] = (int) (v % 10);
+        width += digitWidths[digits[numDigits++]];
+    }
+
+    float x = right - width;
+    labelGlyphs.draw (g, juce::AffineTransform::translation (x, top));
+    x += labelWidth;
+
+    while (--numDigits >= 0)
+    {
+        const int d = digits[numDigits];
+        digitGlyphs[d].draw (g, juce::AffineTransform::translation (x, top));
+        x += digitWidths[d];
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// A label followed by an integer, drawn from glyphs laid out once by prepare().
+//
+// For values that change from one paint to the next, such as the allocation
+// count: formatting them into a String and laying it out would itself allocate
+// on every paint. Here each digit is a cached GlyphArrangement that is only
+// translated into place, so draw() does not touch the heap.
+class NumberReadout
+{
+public:
+    NumberReadout() = default;
+
+    // Lays out the label and the digits 0-9. Call once, outside the paths being measured.
+    void prepare (const juce::Font& font, const juce::String& label);
+
+    // Draws label + value (negative values read 0) with its right edge at `right`
+    // and the top of its line at `top`. Does nothing before prepare().
+    void draw (juce::Graphics& g, juce::int64 value, float right, float top) const;
+
+private:
+    static float getAdvance (const juce::GlyphArrangement& glyphs);
+
+    juce::GlyphArrangement labelGlyphs, digitGlyphs[10];
+    float labelWidth = 0.0f, digitWidths[10] {};
+    bool prepared = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NumberReadout)
+};
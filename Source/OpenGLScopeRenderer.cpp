@@ -0,0 +1,202 @@
+#include "OpenGLScopeRenderer.h"
+
+using namespace juce::gl;
+
+namespace
+{
+    const char* const vertexShaderSource = R"(
+        attribute vec2 position;
+        uniform vec2 viewSize;
+
+        void main()
+        {
+            gl_Position = vec4 (position.x / viewSize.x * 2.0 - 1.0,
+                                1.0 - position.y / viewSize.y * 2.0,
+                                0.0, 1.0);
+        }
+    )";
+
+    const char* const fragmentShaderSource = R"(
+        uniform vec4 colour;
+
+        void main()
+        {
+            gl_FragColor = colour;
+        }
+    )";
+}
+
+OpenGLScopeRenderer::OpenGLScopeRenderer (HistoryStore& store)
+    : historyStore (store)
+{
+    context.setRenderer (this);
+    context.setContinuousRepainting (false);
+}
+
+OpenGLScopeRenderer::~OpenGLScopeRenderer()
+{
+    detach();
+}
+
+void OpenGLScopeRenderer::attachTo (juce::Component& component)
+{
+    if (! context.isAttached())
+        context.attachTo (component);
+}
+
+void OpenGLScopeRenderer::detach()
+{
+    if (context.isAttached())
+        context.detach();
+}
+
+void OpenGLScopeRenderer::setView (int width, int height, float zoomX, float zoomY, juce::int64 endFrame) noexcept
+{
+    viewEndFrame.store (endFrame);
+    viewWidth.store (width);
+    viewHeight.store (height);
+    viewZoomX.store (zoomX);
+    viewZoomY.store (zoomY);
+}
+
+void OpenGLScopeRenderer::newOpenGLContextCreated()
+{
+    auto newShader = std::make_unique<juce::OpenGLShaderProgram> (context);
+
+    if (newShader->addVertexShader (juce::OpenGLHelpers::translateVertexShaderToV3 (vertexShaderSource))
+         && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragmentShaderSource))
+         && newShader->link())
+    {
+        shader = std::move (newShader);
+        viewSizeUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform> (*shader, "viewSize");
+        colourUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform> (*shader, "colour");
+        positionAttribute = glGetAttribLocation (shader->getProgramID(), "position");
+    }
+    else
+    {
+        DBG ("SmoothScope: OpenGL shader compile failed: " << newShader->getLastError());
+    }
+
+    glGenBuffers (1, &vertexBuffer);
+}
+
+void OpenGLScopeRenderer::openGLContextClosing()
+{
+    if (vertexBuffer != 0)
+        glDeleteBuffers (1, &vertexBuffer);
+
+    vertexBuffer = 0;
+    viewSizeUniform.reset();
+    colourUniform.reset();
+    shader.reset();
+}
+
+void OpenGLScopeRenderer::renderOpenGL()
+{
+    juce::OpenGLHelpers::clear (juce::Colours::black);
+
+    const float w = (float) viewWidth.load();
+    const float h = (float) viewHeight.load();
+
+    if (shader == nullptr || positionAttribute < 0 || w <= 0.0f || h <= 0.0f)
+        return;
+
+    const auto scale = (float) context.getRenderingScale();
+    glViewport (0, 0, juce::roundToInt (scale * w), juce::roundToInt (scale * h));
+
+    glEnable (GL_BLEND);
+    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // The GL surface is always redrawn in full, so plan against the whole view.
+    const auto plan = LodPlanner::plan ({ 0, 0, (int) w, (int) h }, (int) w, viewZoomX.load());
+    buildGeometry (w, h, viewZoomX.load(), viewZoomY.load(), viewEndFrame.load(), plan);
+
+    shader->use();
+    viewSizeUniform->set (w, h);
+
+    midLineVertices.assign ({ 0.0f, h * 0.5f, w, h * 0.5f });
+    drawVertices (midLineVertices, GL_LINES, juce::Colours::darkgrey.withAlpha (0.5f));
+
+    drawVertices (peakVertices, GL_LINE_STRIP, juce::Colours::cyan.withAlpha (0.35f));
+    drawVertices (fillVertices, GL_TRIANGLE_STRIP, juce::Colours::cyan.withAlpha (plan.useRaw ? 1.0f : plan.getFillAlpha()));
+    drawVertices (topVertices, GL_LINE_STRIP, juce::Colours::cyan);
+    drawVertices (bottomVertices, GL_LINE_STRIP, juce::Colours::cyan);
+}
+
+void OpenGLScopeRenderer::buildGeometry (float w, float h, float zoomX, float zoomY, juce::int64 endFrame, const LodPlan& plan)
+{
+    fillVertices.clear();
+    topVertices.clear();
+    bottomVertices.clear();
+    peakVertices.clear();
+
+    const ScopeMapping mapping { h, zoomY };
+
+    const juce::ScopedLock sl (historyStore.getLock());
+    const auto& history = historyStore.getPyramid();
+    const auto& peakHistory = historyStore.getPeakPyramid();
+
+    // Distance of the right edge from the newest frame
+    const auto framesAgo = endFrame < 0 ? (juce::int64) 0 : juce::jmax ((juce::int64) 0, history.getNumWritten() - endFrame);
+
+    if (plan.useRaw)
+    {
+        // ZONE 1: one vertex pair per sample, extruded 1px up and down into a 2px ribbon
+        const int samplesToDraw = (int) plan.numSamples;
+
+        if ((int) rawValues.size() < samplesToDraw)
+        {
+            rawValues.resize ((size_t) samplesToDraw);
+            rawPeakValues.resize ((size_t) samplesToDraw);
+        }
+
+        const int numSamples = history.readRaw (plan.firstSample + framesAgo, samplesToDraw, rawValues.data());
+        peakHistory.readRaw (plan.firstSample + framesAgo, samplesToDraw, rawPeakValues.data());
+
+        for (int j = 0; j < numSamples; ++j)
+        {
+            const float x = w - ((float) (plan.firstSample + numSamples - 1 - j) * zoomX);
+            const float y = mapping.toY (rawValues[(size_t) j]);
+
+            fillVertices.insert (fillVertices.end(), { x, y - 1.0f, x, y + 1.0f });
+            peakVertices.insert (peakVertices.end(), { x, mapping.toY (rawPeakValues[(size_t) j]) });
+        }
+
+        return;
+    }
+
+    // ZONE 2 / 3: one envelope column per pixel
+    envelope.compute (historyStore, plan.firstColumn, plan.endColumn, zoomX, framesAgo);
+
+    for (int c = envelope.firstColumn; c < envelope.numColumns; ++c)
+    {
+        const float x = w - (float) c;
+        float yMax = mapping.toY (envelope.rmsMax[(size_t) c]);
+        float yMin = mapping.toY (envelope.rmsMin[(size_t) c]);
+        ScopeMapping::enforceThickness (yMax, yMin, plan.getMinThickness());
+
+        fillVertices.insert (fillVertices.end(), { x, yMax, x, yMin });
+        topVertices.insert (topVertices.end(), { x, yMax });
+        bottomVertices.insert (bottomVertices.end(), { x, yMin });
+        peakVertices.insert (peakVertices.end(), { x, mapping.toY (envelope.peakMax[(size_t) c]) });
+    }
+}
+
+void OpenGLScopeRenderer::drawVertices (const std::vector<float>& vertices, juce::uint32 mode, juce::Colour colour)
+{
+    if (vertices.size() < 4)
+        return;
+
+    colourUniform->set (colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha());
+
+    glBindBuffer (GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData (GL_ARRAY_BUFFER, (GLsizeiptr) (vertices.size() * sizeof (float)), vertices.data(), GL_STREAM_DRAW);
+
+    glEnableVertexAttribArray ((GLuint) positionAttribute);
+    glVertexAttribPointer ((GLuint) positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    glDrawArrays ((GLenum) mode, 0, (GLsizei) (vertices.size() / 2));
+
+    glDisableVertexAttribArray ((GLuint) positionAttribute);
+    glBindBuffer (GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+#include "ColumnEnvelope.h"
+#include "LodPlanner.h"
+
+// Optional GPU render path for the scope trace.
+//
+// The envelope is still reduced on the CPU through the pyramid (cheap, one
+// query per column), but all rasterisation moves to shaders: the envelope is
+// uploaded as a triangle strip and the edges / peak as line strips, instead
+// of building and software-rendering a juce::Path with thousands of segments.
+// Rendering happens on the OpenGL thread; the editor only passes the view.
+class OpenGLScopeRenderer : private juce::OpenGLRenderer
+{
+public:
+    explicit OpenGLScopeRenderer (HistoryStore& store);
+    ~OpenGLScopeRenderer() override;
+
+    void attachTo (juce::Component& component);
+    void detach();
+    bool isAttached() const noexcept { return context.isAttached(); }
+
+    // Called from the message thread whenever size, zoom or position changes.
+    // endFrame is the absolute frame just past the right edge, -1 to follow the write head.
+    void setView (int width, int height, float zoomX, float zoomY, juce::int64 endFrame) noexcept;
+
+    void triggerRepaint() { context.triggerRepaint(); }
+
+private:
+    void newOpenGLContextCreated() override;
+    void renderOpenGL() override;
+    void openGLContextClosing() override;
+
+    void buildGeometry (float w, float h, float zoomX, float zoomY, juce::int64 endFrame, const LodPlan& plan);
+    void drawVertices (const std::vector<float>& vertices, juce::uint32 mode, juce::Colour colour);
+
+    HistoryStore& historyStore;
+    juce::OpenGLContext context;
+
+    std::atomic<int> viewWidth { 0 }, viewHeight { 0 };
+    std::atomic<float> viewZoomX { 1.0f }, viewZoomY { 1.0f };
+    std::atomic<juce::int64> viewEndFrame { -1 };
+
+    std::unique_ptr<juce::OpenGLShaderProgram> shader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> viewSizeUniform, colourUniform;
+    int positionAttribute = -1;
+    juce::uint32 vertexBuffer = 0;
+
+    // Scratch geometry reused every frame (x, y pairs in logical pixels)
+    ColumnEnvelope envelope;
+    std::vector<float> fillVertices, topVertices, bottomVertices, peakVertices, midLineVertices;
+    std::vector<float> rawValues, rawPeakValues;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpenGLScopeRenderer)
+};
@@ -0,0 +1,380 @@
+#include "PersistentHistory.h"
+
+PersistentHistory::PersistentHistory (const juce::File& dir, double rate, juce::int64 first)
+    : directory (dir), frameRate (rate), firstFrame (first)
+{
+    jassert (firstFrame % chunkFrames == 0);
+}
+
+juce::File PersistentHistory::getDefaultRootDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("SmoothScope")
+               .getChildFile ("History");
+}
+
+//==============================================================================
+int PersistentHistory::getNumLevels() noexcept
+{
+    int numLevels = 0;
+
+    for (int size = chunkFrames >> PyramidLayout::branchShift; size >= PyramidLayout::branchFactor; size >>= PyramidLayout::branchShift)
+        ++numLevels;
+
+    return numLevels;
+}
+
+size_t PersistentHistory::getLevelOffset (int lane, int level) noexcept
+{
+    size_t laneBytes = (size_t) chunkFrames * sizeof (float);
+
+    for (int l = 0; l < getNumLevels(); ++l)
+        laneBytes += (size_t) (chunkFrames >> (PyramidLayout::branchShift * (l + 1))) * sizeof (MinMax);
+
+    size_t offset = sizeof (ChunkHeader) + (size_t) lane * laneBytes;
+
+    if (level < 0)
+        return offset;
+
+    offset += (size_t) chunkFrames * sizeof (float);
+
+    for (int l = 0; l < level; ++l)
+        offset += (size_t) (chunkFrames >> (PyramidLayout::branchShift * (l + 1))) * sizeof (MinMax);
+
+    return offset;
+}
+
+size_t PersistentHistory::getChunkFileSize() noexcept
+{
+    return getLevelOffset (numLanes, -1);
+}
+
+juce::File PersistentHistory::getChunkFile (juce::int64 chunkIndex) const
+{
+    return directory.getChildFile ("chunk_" + juce::String (chunkIndex).paddedLeft ('0', 8) + ".sshist");
+}
+
+juce::int64 PersistentHistory::getEndFrame() const noexcept
+{
+    const juce::ScopedLock sl (lock);
+    return firstFrame + (juce::int64) summaries.size() * chunkFrames;
+}
+
+//==============================================================================
+void PersistentHistory::append (const float (&laneValues)[numLanes])
+{
+    if (pending == nullptr)
+    {
+        pending = std::make_unique<PendingChunk>();
+        pending->chunkIndex = nextChunkIndex++;
+
+        for (auto& lane : pending->lanes)
+            lane.resize ((size_t) chunkFrames);
+
+        pendingCount = 0;
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        pending->lanes[lane][(size_t) pendingCount] = laneValues[lane];
+
+    if (++pendingCount == chunkFrames)
+    {
+        // A stopped recording keeps nothing more, so memory does not grow without bound
+        if (hasFailed())
+        {
+            pendingCount = 0;
+            return;
+        }
+
+        const juce::ScopedLock sl (lock);
+        readyToWrite.push_back (std::move (pending));
+    }
+}
+
+void PersistentHistory::flushPending()
+{
+    std::vector<std::unique_ptr<PendingChunk>> toWrite;
+
+    // Backing off after a failed write, or given up
+    if (hasFailed() || (failedAttempts > 0 && (juce::int32) (juce::Time::getMillisecondCounter() - nextAttemptMs) < 0))
+        return;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (readyToWrite.empty())
+            return;
+
+        toWrite.swap (readyToWrite);
+    }
+
+    for (size_t i = 0; i < toWrite.size(); ++i)
+    {
+        ChunkSummary summary;
+
+        if (! writeChunk (*toWrite[i], summary))
+        {
+            getChunkFile (toWrite[i]->chunkIndex).deleteFile();
+
+            const juce::ScopedLock sl (lock);
+
+            // A hole would break the timeline, so rather than skip the chunk the recording
+            // stops here; the RAM ring carries on regardless.
+            if (++failedAttempts >= maxWriteAttempts)
+            {
+                failed.store (true, std::memory_order_relaxed);
+                readyToWrite.clear();
+                return;
+            }
+
+            // Keep it and everything after it for the next attempt
+            nextAttemptMs = juce::Time::getMillisecondCounter() + (retryDelayMs << (failedAttempts - 1));
+            readyToWrite.insert (readyToWrite.begin(),
+                                 std::make_move_iterator (toWrite.begin() + (std::ptrdiff_t) i),
+                                 std::make_move_iterator (toWrite.end()));
+            return;
+        }
+
+        failedAttempts = 0;
+
+        const juce::ScopedLock sl (lock);
+        summaries.push_back (summary);
+    }
+}
+
+bool PersistentHistory::writeChunk (const PendingChunk& chunk, ChunkSummary& summary) const
+{
+    auto file = getChunkFile (chunk.chunkIndex);
+    file.deleteFile();
+
+    juce::FileOutputStream out (file, 1 << 16);
+
+    if (! out.openedOk())
+        return false;
+
+    ChunkHeader header {};
+    std::memcpy (header.magic, "SSH1", 4);
+    header.version = 1;
+    header.chunkIndex = chunk.chunkIndex;
+    header.numFrames = (juce::uint32) chunkFrames;
+    header.numLanes = (juce::uint32) numLanes;
+    header.frameRate = frameRate;
+
+    out.write (&header, sizeof (header));
+
+    std::vector<MinMax> below, level;
+
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        const auto& raw = chunk.lanes[lane];
+        out.write (raw.data(), raw.size() * sizeof (float));
+
+        // Build this chunk's pyramid level by level
+        below.clear();
+
+        for (float v : raw)
+            below.push_back ({ v, v });
+
+        // Same levels as getNumLevels(): keep going while the next level has at least branchFactor entries
+        while ((int) below.size() >= PyramidLayout::branchFactor * PyramidLayout::branchFactor)
+        {
+            level.resize (below.size() / PyramidLayout::branchFactor);
+
+            for (size_t i = 0; i < level.size(); ++i)
+            {
+                MinMax m = below[i * PyramidLayout::branchFactor];
+
+                for (int k = 1; k < PyramidLayout::branchFactor; ++k)
+                {
+                    const auto& e = below[i * PyramidLayout::branchFactor + (size_t) k];
+                    m.min = juce::jmin (m.min, e.min);
+                    m.max = juce::jmax (m.max, e.max);
+                }
+
+                level[i] = m;
+            }
+
+            out.write (level.data(), level.size() * sizeof (MinMax));
+            below.swap (level);
+        }
+
+        MinMax total = below[0];
+
+        for (const auto& e : below)
+        {
+            total.min = juce::jmin (total.min, e.min);
+            total.max = juce::jmax (total.max, e.max);
+        }
+
+        summary.lanes[lane] = total;
+    }
+
+    out.flush();
+    return out.getStatus().wasOk() && (size_t) out.getPosition() == getChunkFileSize();
+}
+
+//==============================================================================
+const juce::uint8* PersistentHistory::mapChunk (juce::int64 chunkIndex) const
+{
+    for (auto it = mappedChunks.begin(); it != mappedChunks.end(); ++it)
+    {
+        if (it->first == chunkIndex)
+        {
+            // Move to the most recently used end
+            std::rotate (it, it + 1, mappedChunks.end());
+            return static_cast<const juce::uint8*> (mappedChunks.back().second->getData());
+        }
+    }
+
+    return addMappedChunk (chunkIndex, openChunk (chunkIndex));
+}
+
+std::unique_ptr<juce::MemoryMappedFile> PersistentHistory::openChunk (juce::int64 chunkIndex) const
+{
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (getChunkFile (chunkIndex), juce::MemoryMappedFile::readOnly);
+
+    if (mapped->getData() == nullptr || mapped->getSize() < getChunkFileSize()
+         || std::memcmp (mapped->getData(), "SSH1", 4) != 0)
+        return nullptr;
+
+    return mapped;
+}
+
+const juce::uint8* PersistentHistory::addMappedChunk (juce::int64 chunkIndex, std::unique_ptr<juce::MemoryMappedFile> mapped) const
+{
+    if (mapped == nullptr)
+        return nullptr;
+
+    if (mappedChunks.size() >= maxMappedChunks)
+        mappedChunks.erase (mappedChunks.begin());
+
+    mappedChunks.emplace_back (chunkIndex, std::move (mapped));
+    return static_cast<const juce::uint8*> (mappedChunks.back().second->getData());
+}
+
+bool PersistentHistory::getSummaryRange (int lane, juce::int64 lo, juce::int64 hi, MinMax& result) const
+{
+    jassert (juce::isPositiveAndBelow (lane, numLanes));
+
+    const juce::ScopedLock sl (lock);
+
+    const juce::int64 firstChunk = firstFrame / chunkFrames;
+    const juce::int64 endChunk = firstChunk + (juce::int64) summaries.size();
+
+    // Every chunk the range touches, even in part
+    const auto first = juce::jmax (firstChunk, juce::jmax (lo, firstFrame) / chunkFrames);
+    const auto end = juce::jmin (endChunk, (hi + chunkFrames - 1) / chunkFrames);
+
+    if (first >= end)
+        return false;
+
+    result = summaries[(size_t) (first - firstChunk)].lanes[lane];
+
+    for (auto chunk = first + 1; chunk < end; ++chunk)
+    {
+        const auto& m = summaries[(size_t) (chunk - firstChunk)].lanes[lane];
+        result.min = juce::jmin (result.min, m.min);
+        result.max = juce::jmax (result.max, m.max);
+    }
+
+    return true;
+}
+
+void PersistentHistory::prefetch (juce::int64 chunkIndex) const
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        const juce::int64 firstChunk = firstFrame / chunkFrames;
+
+        if (chunkIndex < firstChunk || chunkIndex >= firstChunk + (juce::int64) summaries.size())
+            return;
+
+        for (const auto& chunk : mappedChunks)
+            if (chunk.first == chunkIndex)
+                return;
+    }
+
+    auto mapped = openChunk (chunkIndex);
+
+    if (mapped == nullptr)
+        return;
+
+    // Touch one byte per page, so the reads that follow find everything resident
+    const auto* data = static_cast<const volatile juce::uint8*> (mapped->getData());
+    juce::uint8 sum = 0;
+
+    for (size_t offset = 0; offset < getChunkFileSize(); offset += 4096)
+        sum = (juce::uint8) (sum + data[offset]);
+
+    juce::ignoreUnused (sum);
+
+    const juce::ScopedLock sl (lock);
+
+    // A reader may have mapped it itself in the meantime
+    for (const auto& chunk : mappedChunks)
+        if (chunk.first == chunkIndex)
+            return;
+
+    addMappedChunk (chunkIndex, std::move (mapped));
+}
+
+bool PersistentHistory::getRange (int lane, juce::int64 lo, juce::int64 hi, MinMax& result) const
+{
+    jassert (juce::isPositiveAndBelow (lane, numLanes));
+
+    const juce::ScopedLock sl (lock);
+
+    lo = juce::jmax (lo, firstFrame);
+    hi = juce::jmin (hi, firstFrame + (juce::int64) summaries.size() * chunkFrames);
+
+    if (lo >= hi)
+        return false;
+
+    bool found = false;
+    MinMax total { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+
+    auto fold = [&] (const MinMax& m)
+    {
+        total.min = juce::jmin (total.min, m.min);
+        total.max = juce::jmax (total.max, m.max);
+        found = true;
+    };
+
+    const int numLevels = getNumLevels();
+    const juce::int64 firstChunk = firstFrame / chunkFrames;
+
+    for (juce::int64 chunk = lo / chunkFrames; chunk * chunkFrames < hi; ++chunk)
+    {
+        const juce::int64 chunkStart = chunk * chunkFrames;
+        const juce::int64 start = juce::jmax (lo, chunkStart) - chunkStart;
+        const juce::int64 end = juce::jmin (hi, chunkStart + chunkFrames) - chunkStart;
+        const auto& summary = summaries[(size_t) (chunk - firstChunk)];
+
+        if (start == 0 && end == chunkFrames)
+        {
+            fold (summary.lanes[lane]);
+            continue;
+        }
+
+        const auto* data = mapChunk (chunk);
+
+        if (data == nullptr)
+            continue;
+
+        const auto* raw = reinterpret_cast<const float*> (data + getLevelOffset (lane, -1));
+        const MinMax* levels[16] {};
+
+        for (int l = 0; l < numLevels; ++l)
+            levels[l] = reinterpret_cast<const MinMax*> (data + getLevelOffset (lane, l));
+
+        fold (PyramidLayout::reduce (start, end, numLevels,
+                                     [raw] (juce::int64 i) { return raw[i]; },
+                                     [&levels] (int l, juce::int64 i) { return levels[l][i]; }));
+    }
+
+    if (found)
+        result = total;
+
+    return found;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MinMaxPyramid.h"
+
+// Optional disk-backed long-term history, for traces far beyond the RAM ring.
+//
+// Frames are collected into fixed-size chunks aligned to absolute frame
+// positions. A completed chunk is written once as an append-only file holding
+// every lane's raw frames plus its own power-of-four Min/Max levels, and is
+// never touched again. Reads memory-map the chunk files on demand (keeping a
+// small number mapped), and ranges covering whole chunks are answered from a
+// per-chunk summary kept in RAM, so even multi-day views page in very little.
+//
+// File layout (host byte order):
+//   ChunkHeader (64 bytes)
+//   for each lane: float raw[chunkFrames], then MinMax level[l][chunkFrames >> 2 (l + 1)]
+class PersistentHistory
+{
+public:
+    static constexpr int chunkFrames = 65536; // 4^8 frames, ~11 minutes at 100 frames per second
+    static constexpr int numLanes = 2;        // RMS, peak
+
+    // How many chunks a reader should prefetch on each side of a view: a quarter of
+    // the mapped files, so the rest stay with what is on screen
+    static constexpr int maxPrefetchChunks = 8;
+
+    // A chunk that cannot be written is retried this many times, the first retry after
+    // retryDelayMs and each later one after twice the previous wait (~3 s in all).
+    static constexpr int maxWriteAttempts = 5;
+    static constexpr juce::uint32 retryDelayMs = 100;
+
+    // firstFrame must be a multiple of chunkFrames. The directory must exist already:
+    // the constructor does no file I/O, so it can run with the history lock held.
+    PersistentHistory (const juce::File& directory, double frameRate, juce::int64 firstFrame);
+
+    // --- History thread ---
+    // Appends the next frame (one value per lane).
+    void append (const float (&laneValues)[numLanes]);
+
+    // Writes any completed chunks to disk. Must be called without holding the
+    // history lock, as this does file I/O. After a failed write it does nothing until
+    // the retry is due; once a chunk has failed maxWriteAttempts times the recording
+    // stops (see hasFailed()), and what was already written stays readable.
+    void flushPending();
+
+    // True once the recording stopped because chunks could not be written
+    // (disk full, no permission, drive gone). Any thread.
+    bool hasFailed() const noexcept { return failed.load (std::memory_order_relaxed); }
+
+    // --- Readers ---
+    // Min/Max of one lane over the absolute frames [lo, hi), clipped to what is on disk.
+    bool getRange (int lane, juce::int64 lo, juce::int64 hi, MinMax& result) const;
+
+    // Same, but from the in-RAM chunk summaries alone: the range is widened to whole
+    // chunks, and no chunk file is ever mapped. For overviews drawn on the paint thread.
+    bool getSummaryRange (int lane, juce::int64 lo, juce::int64 hi, MinMax& result) const;
+
+    // Maps the chunk file and faults its pages in, so a later getRange() that needs it
+    // does not wait on the disk. The file is opened and read without holding the lock,
+    // so concurrent readers are not held up. Any thread; does nothing for a chunk that
+    // is already mapped or not on disk yet.
+    void prefetch (juce::int64 chunkIndex) const;
+
+    juce::int64 getFirstFrame() const noexcept { return firstFrame; }
+    juce::int64 getEndFrame() const noexcept;
+    const juce::File& getDirectory() const noexcept { return directory; }
+
+    // Where new sessions are recorded by default
+    static juce::File getDefaultRootDirectory();
+
+private:
+    struct ChunkHeader
+    {
+        char magic[4];
+        juce::uint32 version;
+        juce::int64 chunkIndex;
+        juce::uint32 numFrames;
+        juce::uint32 numLanes;
+        double frameRate;
+        juce::uint8 reserved[32];
+    };
+
+    static_assert (sizeof (ChunkHeader) == 64, "Chunk header layout must stay fixed");
+
+    struct PendingChunk
+    {
+        juce::int64 chunkIndex = 0;
+        std::vector<float> lanes[numLanes];
+    };
+
+    struct ChunkSummary
+    {
+        MinMax lanes[numLanes];
+    };
+
+    static int getNumLevels() noexcept;
+    static size_t getLevelOffset (int lane, int level) noexcept; // level -1 = raw
+    static size_t getChunkFileSize() noexcept;
+
+    juce::File getChunkFile (juce::int64 chunkIndex) const;
+    bool writeChunk (const PendingChunk& chunk, ChunkSummary& summary) const;
+    const juce::uint8* mapChunk (juce::int64 chunkIndex) const;
+    std::unique_ptr<juce::MemoryMappedFile> openChunk (juce::int64 chunkIndex) const;
+    const juce::uint8* addMappedChunk (juce::int64 chunkIndex, std::unique_ptr<juce::MemoryMappedFile> mapped) const;
+
+    const juce::File directory;
+    const double frameRate;
+    const juce::int64 firstFrame;
+
+    // Written by the history thread only
+    std::unique_ptr<PendingChunk> pending;
+    int pendingCount = 0;
+    juce::int64 nextChunkIndex = firstFrame / chunkFrames;
+
+    juce::CriticalSection lock;
+    std::vector<std::unique_ptr<PendingChunk>> readyToWrite;
+    std::vector<ChunkSummary> summaries; // one per flushed chunk, starting at firstFrame
+
+    // Write failures, history thread only; see flushPending()
+    int failedAttempts = 0;
+    juce::uint32 nextAttemptMs = 0;
+    std::atomic<bool> failed { false };
+
+    // Lazily mapped chunk files, least recently used first
+    static constexpr size_t maxMappedChunks = 32;
+
+    mutable std::vector<std::pair<juce::int64, std::unique_ptr<juce::MemoryMappedFile>>> mappedChunks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PersistentHistory)
+};
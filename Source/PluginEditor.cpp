@@ -2,70 +2,159 @@
 #include "PluginEditor.h"
 
 SmoothScopeAudioProcessorEditor::SmoothScopeAudioProcessorEditor (SmoothScopeAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), historyStore (p.getHistoryStore()),
+      backgroundRenderer (historyStore), openGLRenderer (historyStore), prefetcher (historyStore)
 {
-    historyBuffer.resize(historySize, 0.0f);
-    overviewBuffer.resize(overviewSize, {0.0f, 0.0f});
+    setWantsKeyboardFocus(true);
 
     setResizable(true, true);
     setResizeLimits(300, 200, 2000, 1000);
     setSize (800, 400);
 
-    startTimerHz(60);
+    // The whole session in one strip: the disk part from chunk summaries, never from the files
+    minimapCache.setDiskSummariesOnly(true);
+
+    if (AllocationCounter::isEnabled)
+        allocationReadout.prepare(juce::Font(juce::FontOptions(14.0f)), "Allocs: ");
+
+    applyViewState();
 }
 
 SmoothScopeAudioProcessorEditor::~SmoothScopeAudioProcessorEditor()
 {
-    stopTimer();
+    openGLRenderer.detach();
 }
 
-void SmoothScopeAudioProcessorEditor::timerCallback()
+void SmoothScopeAudioProcessorEditor::onVBlank()
 {
-    bool newData = false;
-    
-    while (true)
-    {
-        int currentRead = audioProcessor.fifoReadIndex.load(std::memory_order_acquire);
-        int currentWrite = audioProcessor.fifoWriteIndex.load(std::memory_order_acquire);
+    // Nothing to show while the window is hidden or minimised
+    if (! isShowing())
+        return;
 
-        if (currentRead == currentWrite) break; 
+    // In the background, only look at every few vblanks
+    if (! juce::Process::isForegroundProcess() && (++backgroundVBlanks % backgroundVBlankDivider) != 0)
+        return;
 
-        float val = audioProcessor.fifoBuffer[currentRead];
+    // Keep the diagnostics ticking over even when no new data arrives
+    if (showDiagnostics && (++diagnosticsVBlanks % diagnosticsVBlankDivider) == 0)
+        repaint();
 
-        int nextRead = (currentRead + 1) % SmoothScopeAudioProcessor::fifoSize;
-        audioProcessor.fifoReadIndex.store(nextRead, std::memory_order_release);
+    // The host loaded a project while the editor was open
+    if (audioProcessor.getStateGeneration() != lastStateGeneration)
+        applyViewState();
 
-        // 1. Update Raw History
-        historyBuffer[historyWriteIndex] = val;
-        historyWriteIndex = (historyWriteIndex + 1) % historySize;
+    // A frame finished on the render pool is waiting to be blitted
+    if (backgroundRenderer.hasNewFrame())
+        repaint();
 
-        // 2. Accumulate Overview
-        if (val > currentOverviewMax) currentOverviewMax = val;
-        if (val < currentOverviewMin) currentOverviewMin = val;
-        currentOverviewCounter++;
+    updateExportStatus();
 
-        if (currentOverviewCounter >= decimationFactor)
-        {
-            overviewBuffer[overviewWriteIndex] = { currentOverviewMin, currentOverviewMax };
-            overviewWriteIndex = (overviewWriteIndex + 1) % overviewSize;
-            
-            currentOverviewMax = 0.0f;
-            currentOverviewMin = 10.0f;
-            currentOverviewCounter = 0;
-        }
-        
-        newData = true;
+    // The FIFO is drained by the processor's history thread; just check for news.
+    auto numWritten = historyStore.getNumWritten();
+    const int generation = historyStore.getGeneration();
+
+    if (numWritten == lastNumWritten && generation == lastGeneration)
+        return;
+
+    // Wait until the new frames add up to at least one pixel of scroll. Zoomed far
+    // out this skips almost every vblank; a reset of the history always repaints.
+    const bool restarted = (numWritten < lastNumWritten || lastNumWritten < 0 || generation != lastGeneration);
+    const double pixelsScrolled = (double)(numWritten - lastNumWritten) * (double)zoomX;
+
+    if (! restarted && pixelsScrolled < 1.0)
+        return;
+
+    lastNumWritten = numWritten;
+
+    // A paused view stays where it is while the history grows underneath; only the minimap moves on
+    if (isPaused() && ! restarted)
+    {
+        if (showMinimap)
+            repaint(getMinimapBounds());
+
+        return;
     }
 
-    if (newData)
+    if (generation != lastGeneration)
+    {
+        lastGeneration = generation;
+        clearSelection(); // its frames are gone
+        pausedEndFrame = -1;
+        updateOpenGLView();
+        scrollCache.invalidate();
+        minimapCache.invalidate();
+        minimapSpan = minimapMinSpan;
+        backgroundRenderer.invalidate();
+    }
+
+    if (openGLRenderer.isAttached() && laneView == LaneView::mix)
+    {
+        openGLRenderer.triggerRepaint();
+
+        // The GPU only draws the detail view; the minimap strip is still painted here
+        if (showMinimap)
+            repaint(getMinimapBounds());
+    }
+    else
+    {
         repaint();
+    }
 }
 
 void SmoothScopeAudioProcessorEditor::paint (juce::Graphics& g)
 {
+    // Steady-state painting should not touch the heap (see AllocationCounter)
+    const AllocationCounter::Scope allocations;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (showMinimap)
+        paintMinimap(g);
+
+    // The detail view below it; a repaint of the minimap alone skips it (and its timing)
+    {
+        const juce::Graphics::ScopedSaveState state (g);
+        const auto detail = getDetailBounds();
+
+        if (! g.reduceClipRegion(detail))
+            return;
+
+        g.setOrigin(detail.getPosition());
+
+        paintedZone = ScopeStats::rawZone;
+        pointsEmitted = 0;
+        paintScope(g);
+
+        lastPaintAllocations = allocations.getCount();
+
+        auto& stats = audioProcessor.getStats();
+        const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+        stats.paintTime[paintedZone].record(juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e6);
+        stats.pointsPerFrame.store(pointsEmitted, std::memory_order_relaxed);
+        stats.allocationsPerFrame.store(lastPaintAllocations, std::memory_order_relaxed);
+
+        // Drawn once the figures are taken, so its own formatting does not show up in them
+        if (showDiagnostics)
+            paintDiagnostics(g);
+    }
+}
+
+void SmoothScopeAudioProcessorEditor::paintScope (juce::Graphics& g)
+{
+    // Page in the disk history around the view, ready for the next pan
+    if (historyStore.isPersistenceEnabled())
+        prefetcher.request({ getViewEndFrame(), getWidth(), zoomX });
+
+    if (openGLRenderer.isAttached() && laneView == LaneView::mix)
+    {
+        // The GPU draws the trace underneath; only the overlay is painted here.
+        paintedZone = ScopeStats::gpuZone;
+        paintOverlay(g);
+        return;
+    }
+
     g.fillAll (juce::Colours::black);
 
-    auto area = getLocalBounds();
+    auto area = getDetailBounds().withZeroOrigin();
     float w = (float)area.getWidth();
     float h = (float)area.getHeight();
     float midY = h / 2.0f;
@@ -73,9 +162,31 @@ void SmoothScopeAudioProcessorEditor::paint (juce::Graphics& g)
     g.setColour(juce::Colours::darkgrey.withAlpha(0.5f));
     g.drawHorizontalLine((int)midY, 0.0f, w);
 
-    bool useOverview = (zoomX < 0.05f); 
+    const juce::ScopedLock sl (historyStore.getLock());
+    const auto& history = historyStore.getPyramid();
+    const auto& peakHistory = historyStore.getPeakPyramid();
+    const ScopeMapping mapping { h, zoomY };
+    const auto framesAgo = getViewFramesAgo();
 
-    if (zoomX >= 1.0f)
+    // One plan for every zone: only what intersects the clip region is drawn.
+    lodPlan = LodPlanner::plan(g.getClipBounds(), (int)w, zoomX);
+
+    if (laneView != LaneView::mix)
+    {
+        paintedZone = ScopeStats::laneZone;
+
+        if (laneView == LaneView::bands)         paintBands(g);
+        else if (laneView == LaneView::loudness) paintLoudness(g);
+        else                                     paintLanes(g);
+
+        paintOverlay(g);
+        return;
+    }
+
+    // Peak is drawn as a faint line behind the RMS trace
+    const auto peakColour = juce::Colours::cyan.withAlpha(0.35f);
+
+    if (lodPlan.useRaw)
     {
         // ============================================================
         // ZONE 1: HIGH ZOOM (ZoomX >= 1.0)
@@ -83,187 +194,769 @@ void SmoothScopeAudioProcessorEditor::paint (juce::Graphics& g)
         // NO PIXEL GROUPING. This restores the perfect smoothness.
         // ============================================================
         
-        juce::Path path;
+        auto& path = tracePath;
+        auto& peakPath = tracePeakPath;
+        path.clear();
+        peakPath.clear();
         bool started = false;
 
-        int samplesToDraw = (int)std::ceil(w / zoomX) + 2;
-        if (samplesToDraw > historySize) samplesToDraw = historySize;
+        const int samplesToDraw = (int)lodPlan.numSamples;
 
-        for (int i = 0; i < samplesToDraw; ++i)
+        // Sized in resized(); only grows here if the plan ever asks for more
+        if ((int)rawValues.size() < samplesToDraw)
+            reserveScratch(samplesToDraw, 0);
+
+        // The visible window decoded into contiguous arrays, oldest first.
+        // RMS and peak lanes have the same length, so they line up.
+        const int numSamples = history.readRaw(lodPlan.firstSample + framesAgo, samplesToDraw, rawValues.data());
+        peakHistory.readRaw(lodPlan.firstSample + framesAgo, samplesToDraw, rawPeakValues.data());
+
+        mapping.toY(rawValues.data(), yValues.data(), numSamples);
+        mapping.toY(rawPeakValues.data(), yPeakValues.data(), numSamples);
+
+        for (int j = 0; j < numSamples; ++j)
         {
             // Use precise floating point X. 
             // This allows the curve to slide smoothly between pixels.
-            float x = w - ((float)i * zoomX);
-            
-            float val = getSample(historyBuffer, historyWriteIndex, i);
-            float y = midY - (val * midY * 0.9f * zoomY);
-            y = juce::jlimit(0.0f, h, y);
-
-            if (!started) { path.startNewSubPath(x, y); started = true; }
-            else          { path.lineTo(x, y); }
+            float x = w - ((float)(lodPlan.firstSample + numSamples - 1 - j) * zoomX);
+
+            float y = yValues[(size_t)j];
+            float yPeak = yPeakValues[(size_t)j];
+
+            if (!started) { path.startNewSubPath(x, y); peakPath.startNewSubPath(x, yPeak); started = true; }
+            else          { path.lineTo(x, y); peakPath.lineTo(x, yPeak); }
         }
         
+        g.setColour(peakColour);
+        g.strokePath(peakPath, juce::PathStrokeType(1.0f));
+
         g.setColour(juce::Colours::cyan);
         g.strokePath(path, juce::PathStrokeType(2.0f, juce::PathStrokeType::curved));
+
+        pointsEmitted = 2 * numSamples;
+
+        // True-peak layer on top, one single-frame query per sample (a few hundred at most)
+        if (historyStore.hasTruePeakLane())
+        {
+            peakPath.clear();
+
+            for (int j = 0; j < numSamples; ++j)
+            {
+                const auto samplesAgo = lodPlan.firstSample + numSamples - 1 - j;
+
+                MinMax truePeak;
+                if (! historyStore.getRange(HistoryStore::truePeakLane, samplesAgo + framesAgo, 1, truePeak))
+                    truePeak.max = rawPeakValues[(size_t)j];
+
+                const float x = w - ((float)samplesAgo * zoomX);
+                const float y = mapping.toY(truePeak.max);
+
+                if (j == 0) peakPath.startNewSubPath(x, y);
+                else        peakPath.lineTo(x, y);
+            }
+
+            g.setColour(juce::Colours::orange.withAlpha(0.6f));
+            g.strokePath(peakPath, juce::PathStrokeType(1.0f));
+            pointsEmitted += numSamples;
+        }
     }
-    else if (useOverview)
+    else
     {
+        paintedZone = (zoomX < LodPlanner::detailZoom) ? ScopeStats::overviewZone : ScopeStats::midZone;
+
         // ============================================================
         // ZONE 2: OVERVIEW / EXTREME ZOOM OUT (ZoomX < 0.05)
-        // Strategy: Pre-Calculated MinMax Buffer.
+        // ZONE 3: MID RANGE (0.05 <= ZoomX < 1.0)
+        // Strategy: Pixel Grouping via the Min/Max Pyramid.
+        // Each column is one O(log N) range query (see ColumnEnvelope),
+        // so the cost depends on the visible width only.
+        // The mid range additionally enforces a minimum thickness, which
+        // fixes the "Moiré Shivering". It fades in between the zones
+        // (see LodPlan::detail) rather than switching on at 0.05.
         // ============================================================
-        
-        std::vector<juce::Point<float>> pointsMax;
-        std::vector<juce::Point<float>> pointsMin;
-        pointsMax.reserve((int)w);
-        pointsMin.reserve((int)w);
 
-        float pointSpacing = zoomX * (float)decimationFactor;
-        
-        for (int i = 0; i < overviewSize; ++i)
+        if (useScrollCache)
         {
-            float x = w - ((float)i * pointSpacing);
-            if (x < -10.0f) break;
-
-            MinMax val = getSample(overviewBuffer, overviewWriteIndex, i);
-            
-            float yMax = midY - (val.max * midY * 0.9f * zoomY);
-            float yMin = midY - (val.min * midY * 0.9f * zoomY);
-            
-            yMax = juce::jlimit(0.0f, h, yMax);
-            yMin = juce::jlimit(0.0f, h, yMin);
-            
-            pointsMax.emplace_back(x, yMax);
-            pointsMin.emplace_back(x, yMin);
+            // Only the columns touched by new frames are rasterised
+            pointsEmitted = scrollCache.draw(g, historyStore, (int)w, (int)h, zoomX, zoomY, lodPlan,
+                                             history.getNumWritten() - framesAgo);
+            paintOverlay(g);
+            return;
         }
 
-        if (!pointsMax.empty())
+        if (useBackgroundRender)
         {
-            juce::Path fillPath;
-            fillPath.startNewSubPath(pointsMax[0]);
-            for (size_t i = 1; i < pointsMax.size(); ++i) fillPath.lineTo(pointsMax[i]);
-            for (int i = (int)pointsMin.size() - 1; i >= 0; --i) fillPath.lineTo(pointsMin[i]);
-            fillPath.closeSubPath();
-
-            g.setColour(juce::Colours::cyan.withAlpha(0.5f));
-            g.fillPath(fillPath);
-            g.setColour(juce::Colours::cyan);
-            g.strokePath(fillPath, juce::PathStrokeType(1.0f));
+            // Reduced and rasterised on the shared render pool; here we only blit.
+            // The view is pinned to the frame count onVBlank() decided to show (or
+            // to the paused position), so an unchanged view does not trigger another render.
+            const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+            backgroundRenderer.request({ (int)w, (int)h, scale, zoomX, zoomY, getViewEndFrame() });
+            if (backgroundRenderer.draw(g, (int)w, (int)h))
+                pointsEmitted = backgroundRenderer.getDrawnPoints();
+
+            paintOverlay(g);
+            return;
         }
+
+        envelope.compute(historyStore, lodPlan.firstColumn, lodPlan.endColumn, zoomX, framesAgo);
+        pointsEmitted = envelope.paint(g, mapping, w, juce::Colours::cyan, lodPlan.getMinThickness(), lodPlan.getFillAlpha(),
+                                       envelopeFillPath, envelopePeakPath);
     }
-    else
+
+    paintOverlay(g);
+}
+
+void SmoothScopeAudioProcessorEditor::paintLanes (juce::Graphics& g)
+{
+    // ============================================================
+    // LANE VIEWS: one envelope per input channel.
+    // Stacked gives every channel its own strip, Overlaid draws them
+    // on top of each other in different colours. Channel lanes have
+    // no raw zone of their own, so every zoom level uses the envelope.
+    // ============================================================
+
+    // Called from paint() with the history lock held.
+    const float w = (float)getWidth();
+    const float h = (float)getDetailBounds().getHeight();
+
+    const int numLanes = historyStore.getNumChannelLanes();
+
+    if (numLanes == 0)
+        return;
+
+    const bool stacked = (laneView == LaneView::stacked);
+    const float stripHeight = stacked ? h / (float)numLanes : h;
+
+    // Channel names, e.g. "L", "R", "C", "Ls" - only rebuilt when the layout changes
+    if (laneNames.size() != numLanes)
     {
-        // ============================================================
-        // ZONE 3: MID RANGE (0.05 <= ZoomX < 1.0)
-        // Strategy: Pixel Grouping + Thickness Enforcement.
-        // This fixes the "DAW Lag" AND the "Moiré Shivering".
-        // ============================================================
+        const auto layout = audioProcessor.getChannelLayoutOfBus(true, 0);
+        laneNames.clear();
 
-        std::vector<juce::Point<float>> pointsMax;
-        std::vector<juce::Point<float>> pointsMin;
-        pointsMax.reserve((int)w);
-        pointsMin.reserve((int)w);
-        
-        float samplesPerPixel = 1.0f / zoomX;
+        for (int ch = 0; ch < numLanes; ++ch)
+            laneNames.add(layout.size() > ch ? juce::AudioChannelSet::getAbbreviatedChannelTypeName(layout.getTypeOfChannel(ch))
+                                             : juce::String(ch + 1));
+    }
+
+    for (int ch = 0; ch < numLanes; ++ch)
+    {
+        const ScopeMapping mapping { stripHeight, zoomY, stacked ? stripHeight * (float)ch : 0.0f };
+        const auto colour = juce::Colour::fromHSV((float)ch / (float)numLanes, 0.7f, 1.0f, 1.0f);
+
+        envelope.compute(historyStore, lodPlan.firstColumn, lodPlan.endColumn, zoomX, getViewFramesAgo(),
+                         historyStore.getChannelLane(ch), -1, -1);
+        pointsEmitted += envelope.paint(g, mapping, w, colour, lodPlan.getMinThickness(), stacked ? lodPlan.getFillAlpha() : 0.25f,
+                                        envelopeFillPath, envelopePeakPath);
 
-        // Iterate Screen Pixels (w down to 0)
-        for (int x = (int)w; x >= 0; --x)
+        if (stacked)
         {
-            float distanceFromRight = (float)((int)w - x);
-            
-            // Calculate Range in Buffer
-            float startSample = distanceFromRight * samplesPerPixel;
-            float endSample   = (distanceFromRight + 1.0f) * samplesPerPixel;
-            
-            int iStart = (int)startSample;
-            int iEnd   = (int)endSample;
-            if (iEnd <= iStart) iEnd = iStart + 1;
-            
-            // Scan for Min/Max in Raw Buffer
-            // We inline the scan here for clarity/speed in this specific loop
-            float maxV = -1.0f;
-            float minV = 10.0f;
-            
-            for (int i = iStart; i < iEnd; ++i)
-            {
-                // Check bounds
-                if (i >= historySize) break; 
+            g.setColour(juce::Colours::darkgrey.withAlpha(0.5f));
+            if (ch > 0) g.drawHorizontalLine((int)mapping.top, 0.0f, w);
+        }
 
-                float val = getSample(historyBuffer, historyWriteIndex, i);
-                if (val > maxV) maxV = val;
-                if (val < minV) minV = val;
-            }
+        g.setColour(colour);
+        g.setFont(12.0f);
+        g.drawText(laneNames[ch], (int)w - 40, stacked ? (int)mapping.top + 4 : 30 + ch * 14, 34, 14, juce::Justification::topRight);
+    }
+}
+
+void SmoothScopeAudioProcessorEditor::paintBands (juce::Graphics& g)
+{
+    // ============================================================
+    // BAND VIEW: one row per spectral band, lowest at the bottom,
+    // level as colour. Each cell is one O(log N) query on its band
+    // lane, written into an image with one pixel per column and band
+    // that is then stretched over the editor.
+    // ============================================================
 
-            // If we found data (valid range)
-            if (maxV >= 0.0f)
+    // Called from paint() with the history lock held.
+    const int w = getWidth();
+    const int numBands = historyStore.getNumBandLanes();
+
+    if (numBands == 0)
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(14.0f);
+        g.drawText("Band analysis is off (press F)", getDetailBounds().withZeroOrigin(), juce::Justification::centred);
+        return;
+    }
+
+    // Only reallocated when the editor is resized
+    if (bandImage.getWidth() != w || bandImage.getHeight() != numBands)
+        bandImage = juce::Image(juce::Image::RGB, w, numBands, true);
+
+    // zoomY magnifies as it does for the trace: the colour scale spans 60 dB / zoomY
+    const float floorDb = -60.0f / zoomY;
+    const double samplesPerPixel = 1.0 / (double)zoomX;
+    const int endColumn = juce::jmin(lodPlan.endColumn, w);
+    const auto framesAgo = getViewFramesAgo();
+
+    {
+        juce::Image::BitmapData pixels(bandImage, juce::Image::BitmapData::writeOnly);
+
+        for (int column = lodPlan.firstColumn; column < endColumn; ++column)
+        {
+            juce::int64 iStart = framesAgo + (juce::int64)((double)column * samplesPerPixel);
+            juce::int64 iEnd   = juce::jmax(iStart + 1, framesAgo + (juce::int64)((double)(column + 1) * samplesPerPixel));
+
+            for (int b = 0; b < numBands; ++b)
             {
-                float yMax = midY - (maxV * midY * 0.9f * zoomY);
-                float yMin = midY - (minV * midY * 0.9f * zoomY);
-                
-                yMax = juce::jlimit(0.0f, h, yMax);
-                yMin = juce::jlimit(0.0f, h, yMin);
-
-                // --- THICKNESS ENFORCEMENT ---
-                // This fixes the "Moiré Shivering".
-                // If the tube is too thin (< 1.5px), widen it artificially.
-                float height = std::abs(yMin - yMax);
-                const float minThickness = 1.5f;
-
-                if (height < minThickness)
-                {
-                    float center = (yMax + yMin) * 0.5f;
-                    yMax = center - (minThickness * 0.5f);
-                    yMin = center + (minThickness * 0.5f);
-                }
-                // -----------------------------
-
-                pointsMax.emplace_back((float)x, yMax);
-                pointsMin.emplace_back((float)x, yMin);
+                MinMax range;
+                const float level = historyStore.getRange(HistoryStore::getBandLane(b), iStart, iEnd - iStart, range) ? range.max : 0.0f;
+                const float t = level > 0.0f ? juce::jlimit(0.0f, 1.0f, 1.0f - 20.0f * std::log10(level) / floorDb) : 0.0f;
+
+                pixels.setPixelColour(w - 1 - column, numBands - 1 - b, juce::Colour::fromHSV(0.66f * (1.0f - t), 0.9f, t, 1.0f));
             }
         }
+    }
+
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+    g.drawImage(bandImage, 0, 0, w, getDetailBounds().getHeight(), 0, 0, w, numBands);
+
+    pointsEmitted = juce::jmax(0, endColumn - lodPlan.firstColumn) * numBands;
+}
+
+void SmoothScopeAudioProcessorEditor::paintLoudness (juce::Graphics& g)
+{
+    // ============================================================
+    // LOUDNESS VIEW: momentary loudness (400 ms) as the envelope,
+    // short-term (3 s) as its line. Both lanes are K-weighted levels
+    // on the same scale as the trace, so zoomY works as usual; the
+    // readout gives them, and the integrated value, in LUFS.
+    // ============================================================
+
+    // Called from paint() with the history lock held.
+    if (! historyStore.hasLoudnessLanes())
+    {
+        g.setColour(juce::Colours::grey);
+        g.setFont(14.0f);
+        g.drawText("Loudness measurement is off (press K)", getDetailBounds().withZeroOrigin(), juce::Justification::centred);
+        return;
+    }
+
+    const float w = (float)getWidth();
+    const ScopeMapping mapping { (float)getDetailBounds().getHeight(), zoomY };
+
+    envelope.compute(historyStore, lodPlan.firstColumn, lodPlan.endColumn, zoomX, getViewFramesAgo(),
+                     HistoryStore::momentaryLane, HistoryStore::shortTermLane, -1);
+    pointsEmitted = envelope.paint(g, mapping, w, juce::Colours::gold, lodPlan.getMinThickness(), lodPlan.getFillAlpha(),
+                                   envelopeFillPath, envelopePeakPath);
+
+    const auto loudness = historyStore.getLoudness();
+    const float readings[] { loudness.momentary, loudness.shortTerm, loudness.integrated };
+
+    auto toTenths = [] (float lufs) { return lufs > -1000.0f ? juce::roundToInt(lufs * 10.0f) : std::numeric_limits<int>::min(); };
+
+    bool changed = loudnessReadout.getNumGlyphs() == 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        changed = changed || toTenths(readings[i]) != loudnessTenths[i];
+        loudnessTenths[i] = toTenths(readings[i]);
+    }
+
+    if (changed)
+    {
+        auto format = [] (float lufs) { return lufs > -1000.0f ? juce::String(lufs, 1) : juce::String("-inf"); };
+
+        const auto text = "M " + format(readings[0]) + "   S " + format(readings[1]) + "   I " + format(readings[2]) + " LUFS";
+
+        loudnessReadout.clear();
+        loudnessReadout.addFittedText(juce::Font(juce::FontOptions(14.0f)), text,
+                                      w - 330.0f, 30.0f, 320.0f, 20.0f, juce::Justification::topRight, 1);
+    }
+
+    g.setColour(juce::Colours::gold);
+    loudnessReadout.draw(g);
+}
+
+void SmoothScopeAudioProcessorEditor::paintOverlay (juce::Graphics& g)
+{
+    // The text only changes with the view state, so its glyphs are laid out once
+    // and redrawn from the cache; building Strings every frame would allocate.
+    const auto& exporter = audioProcessor.getHistoryExporter();
+    const int exportPercent = exporter.isExporting() ? juce::roundToInt(exporter.getProgress() * 100.0f) : -1;
+
+    juce::int64 eventCounts[EventLog::numTypes];
+    bool diskFailed;
+
+    {
+        const juce::ScopedLock sl(historyStore.getLock());
+        diskFailed = historyStore.hasPersistenceFailed();
+
+        for (int type = 0; type < EventLog::numTypes; ++type)
+            eventCounts[type] = historyStore.getEventLog().getNumEvents(type);
+    }
+
+    const OverlayState state { zoomX, (int)laneView, openGLRenderer.isAttached(), useScrollCache,
+                               useBackgroundRender, historyStore.isPersistenceEnabled(),
+                               exportPercent, fileStatusChanges, selectionChanges, saveHistoryInState,
+                               audioProcessor.isTruePeakEnabled(), audioProcessor.isLoudnessEnabled(),
+                               audioProcessor.isBroadcastEnabled(), pausedEndFrame,
+                               eventCounts[EventLog::clip] + eventCounts[EventLog::over] + eventCounts[EventLog::silence],
+                               diskFailed };
+
+    if (! (state == overlayState) || overlayText.getNumGlyphs() == 0)
+    {
+        overlayState = state;
+
+        // Stats
+        juce::String mode;
+        if (zoomX >= LodPlanner::rawZoom) mode = "Mode: RAW (Float)";
+        else if (zoomX < LodPlanner::detailZoom) mode = state.persistence ? "Mode: OVERVIEW (Pyramid + Disk)" : "Mode: OVERVIEW (Pyramid)";
+        else mode = "Mode: MID (Enforced Envelope)";
+
+        if (laneView == LaneView::stacked) mode = "Mode: LANES (Stacked)";
+        else if (laneView == LaneView::overlaid) mode = "Mode: LANES (Overlaid)";
+        else if (laneView == LaneView::bands) mode = "Mode: BANDS (" + juce::String(SpectralAnalyser::numBands) + " x 1/3 oct)";
+        else if (laneView == LaneView::loudness) mode = "Mode: LOUDNESS (BS.1770)";
+        else if (state.openGL) mode += " [GPU]";
+        else if (useScrollCache && zoomX < 1.0f) mode += " [Cached]";
+        else if (useBackgroundRender && zoomX < 1.0f) mode += " [Worker]";
+
+        juce::String text = mode + " | Zoom: " + juce::String(zoomX, 5);
+
+        if (state.truePeak)
+            text += " | True peak";
+
+        if (state.loudness)
+            text += " | LUFS";
+
+        if (state.broadcast)
+            text += " | Broadcasting";
+
+        if (saveHistoryInState)
+            text += " | Saving history";
+
+        if (state.diskFailed)
+            text += " | Disk history stopped: could not write (P to restart)";
+
+        if (state.numEvents > 0)
+            text += " | Events: " + juce::String(eventCounts[EventLog::clip]) + " clip, " + juce::String(eventCounts[EventLog::over])
+                  + " over, " + juce::String(eventCounts[EventLog::silence]) + " silence ([ ] to jump)";
+
+        if (isPaused())
+        {
+            // Position of the right edge since recording started
+            const double seconds = (double)pausedEndFrame / audioProcessor.getFrameRate();
+            const int minutes = (int)(seconds / 60.0);
+            text += " | Paused at " + juce::String(minutes / 60) + ":" + juce::String(minutes % 60).paddedLeft('0', 2)
+                  + ":" + juce::String(seconds - 60.0 * minutes, 1).paddedLeft('0', 4) + " (Z = live)";
+        }
+
+        if (exportPercent >= 0)           text += " | Exporting: " + juce::String(exportPercent) + "%";
+        else if (fileStatus.isNotEmpty()) text += " | " + fileStatus;
+
+        overlayText.clear();
+        overlayText.addFittedText(juce::Font(juce::FontOptions(14.0f)), text,
+                                  10.0f, 10.0f, 700.0f, 20.0f, juce::Justification::topLeft, 1);
+
+        if (hasSelection)
+            overlayText.addFittedText(juce::Font(juce::FontOptions(14.0f)), selectionText,
+                                      10.0f, 30.0f, 700.0f, 20.0f, juce::Justification::topLeft, 1);
+    }
+
+    paintEventMarkers(g, getViewEndFrame(), zoomX, (float)getWidth(), 0.0f, (float)getDetailBounds().getHeight());
+
+    if (hasSelection)
+    {
+        // Pinned to the frames shown, so it moves with the trace
+        const float w = (float)getWidth();
+        const auto viewEnd = getViewEndFrame();
+        const float x1 = juce::jmax(0.0f, w - (float)(viewEnd - selectionStart) * zoomX);
+        const float x2 = juce::jmin(w, w - (float)(viewEnd - selectionEnd) * zoomX);
 
-        if (!pointsMax.empty())
+        if (x2 > x1)
         {
-            juce::Path fillPath;
-            // Trace Roof (Right to Left)
-            fillPath.startNewSubPath(pointsMax[0]);
-            for (size_t i = 1; i < pointsMax.size(); ++i) fillPath.lineTo(pointsMax[i]);
-            
-            // Trace Floor (Left to Right - reverse order of collection)
-            // Since we collected Right-to-Left (w to 0), pointsMin[0] is Right.
-            // We want to draw from Left (last point) back to Right (first point) to close loop?
-            // Actually, Roof went Right->Left.
-            // To close polygon, Floor should go Left->Right.
-            // pointsMin is Right->Left. So we iterate it backwards.
-            for (int i = (int)pointsMin.size() - 1; i >= 0; --i) fillPath.lineTo(pointsMin[i]);
-            
-            fillPath.closeSubPath();
-
-            // Draw solid
-            g.setColour(juce::Colours::cyan.withAlpha(0.6f));
-            g.fillPath(fillPath);
-            
-            // Optional: lighter stroke on edges for definition
-            g.setColour(juce::Colours::cyan);
-            g.strokePath(fillPath, juce::PathStrokeType(1.0f));
+            g.setColour(juce::Colours::white.withAlpha(0.12f));
+            g.fillRect(x1, 0.0f, x2 - x1, (float)getDetailBounds().getHeight());
         }
     }
 
-    // Stats
     g.setColour(juce::Colours::white);
-    g.setFont(14.0f);
-    juce::String mode;
-    if (zoomX >= 1.0f) mode = "Mode: RAW (Float)";
-    else if (useOverview) mode = "Mode: OVERVIEW (MinMax)";
-    else mode = "Mode: MID (Enforced Envelope)";
-    
-    g.drawText(mode + " | Zoom: " + juce::String(zoomX, 5), 
-               10, 10, 300, 20, juce::Justification::topLeft);
+    overlayText.draw(g);
+
+    if (AllocationCounter::isEnabled)
+        allocationReadout.draw(g, lastPaintAllocations, (float)getWidth() - 10.0f, 10.0f);
+}
+
+void SmoothScopeAudioProcessorEditor::paintDiagnostics (juce::Graphics& g)
+{
+    // Diagnostics only: this builds its text every time, so it is not allocation-free.
+    // paint() calls it after recording the paint's time and allocations.
+    const auto stats = audioProcessor.getStatsSnapshot();
+
+    auto timing = [] (const TimingHistogram::Summary& t)
+    {
+        if (t.count == 0)
+            return juce::String("-");
+
+        return juce::String(t.minUs, 1) + " / " + juce::String(t.meanUs, 1) + " / " + juce::String(t.p99Us, 1)
+             + " us (n=" + juce::String(t.count) + ")";
+    };
+
+    juce::StringArray lines;
+    lines.add("processBlock min/mean/p99: " + timing(stats.processBlock));
+    lines.add("FIFO: " + juce::String(stats.fifoFill) + " / " + juce::String(stats.fifoCapacity)
+              + " | pushed " + juce::String(stats.framesPushed) + " | dropped " + juce::String(stats.framesDropped));
+    lines.add("Drain per tick: last " + juce::String(stats.lastDrained) + " | mean " + juce::String(stats.meanDrained, 2)
+              + " | max " + juce::String(stats.maxDrained));
+
+    for (int z = 0; z < ScopeStats::numZones; ++z)
+        if (stats.paint[z].count > 0)
+            lines.add("Paint " + juce::String(ScopeStats::getZoneName(z)) + " min/mean/p99: " + timing(stats.paint[z]));
+
+    lines.add("Points/frame: " + juce::String(stats.pointsPerFrame)
+              + (AllocationCounter::isEnabled ? " | Allocs/frame: " + juce::String(stats.allocationsPerFrame)
+                                              : juce::String(" | Allocs/frame: n/a (SMOOTHSCOPE_COUNT_ALLOCATIONS off)")));
+
+    const int lineHeight = 15;
+    const juce::Rectangle<int> box (10, 34, 480, lines.size() * lineHeight + 8);
+
+    g.setColour(juce::Colours::black.withAlpha(0.7f));
+    g.fillRect(box);
+
+    // Dropped frames are what matters most when the scope stutters
+    g.setColour(stats.framesDropped > 0 ? juce::Colours::orange : juce::Colours::lightgrey);
+    g.setFont(12.0f);
+
+    for (int i = 0; i < lines.size(); ++i)
+        g.drawText(lines[i], box.getX() + 6, box.getY() + 4 + i * lineHeight, box.getWidth() - 12, lineHeight,
+                   juce::Justification::centredLeft);
+}
+
+bool SmoothScopeAudioProcessorEditor::keyPressed (const juce::KeyPress& key)
+{
+    // 'G' toggles the OpenGL render path; the Graphics path is the fallback.
+    if (key.getTextCharacter() == 'g' || key.getTextCharacter() == 'G')
+    {
+        if (openGLRenderer.isAttached()) openGLRenderer.detach();
+        else                             openGLRenderer.attachTo(*this);
+
+        updateOpenGLView();
+        repaint();
+        return true;
+    }
+
+    // 'P' toggles the disk-backed long-term history, or starts a new recording after a write failure.
+    if (key.getTextCharacter() == 'p' || key.getTextCharacter() == 'P')
+    {
+        bool failed;
+
+        {
+            const juce::ScopedLock sl(historyStore.getLock());
+            failed = historyStore.hasPersistenceFailed();
+        }
+
+        if (failed && historyStore.isPersistenceEnabled())
+            historyStore.setPersistenceEnabled(false);
+
+        historyStore.setPersistenceEnabled(failed || ! historyStore.isPersistenceEnabled());
+        zoomX = juce::jlimit(getMinZoomX(), maxZoomX, zoomX);
+        scrollCache.invalidate();
+
+        // Switching it off takes the disk part of the history with it
+        if (isPaused())
+            setViewEndFrame(pausedEndFrame);
+
+        updateOpenGLView();
+        repaint();
+        return true;
+    }
+
+    // 'C' toggles the cached-image scrolling mode for the envelope zones.
+    if (key.getTextCharacter() == 'c' || key.getTextCharacter() == 'C')
+    {
+        useScrollCache = ! useScrollCache;
+        scrollCache.invalidate();
+        repaint();
+        return true;
+    }
+
+    // 'B' toggles rendering the envelope zones on the shared render pool.
+    if (key.getTextCharacter() == 'b' || key.getTextCharacter() == 'B')
+    {
+        useBackgroundRender = ! useBackgroundRender;
+        backgroundRenderer.invalidate();
+        repaint();
+        return true;
+    }
+
+    // 'D' toggles the diagnostics overlay.
+    if (key.getTextCharacter() == 'd' || key.getTextCharacter() == 'D')
+    {
+        showDiagnostics = ! showDiagnostics;
+        repaint();
+        return true;
+    }
+
+    // 'E' exports the whole RAM history, Shift+E the drag selection (or what is on screen if none).
+    // Pressing it again while an export runs cancels it.
+    if (key.getTextCharacter() == 'e' || key.getTextCharacter() == 'E')
+    {
+        auto& exporter = audioProcessor.getHistoryExporter();
+
+        if (exporter.isExporting()) exporter.cancel();
+        else                        launchExport(key.getModifiers().isShiftDown());
+
+        return true;
+    }
+
+    // 'L' cycles Mix -> Stacked -> Overlaid channel lanes -> Spectral bands -> Loudness.
+    if (key.getTextCharacter() == 'l' || key.getTextCharacter() == 'L')
+    {
+        laneView = (laneView == LaneView::mix)      ? LaneView::stacked
+                 : (laneView == LaneView::stacked)  ? LaneView::overlaid
+                 : (laneView == LaneView::overlaid) ? LaneView::bands
+                 : (laneView == LaneView::bands)    ? LaneView::loudness
+                                                    : LaneView::mix;
+        scrollCache.invalidate();
+        storeViewState();
+        repaint();
+        return true;
+    }
+
+    // 'Z' pauses the view (recording carries on) or goes back to following the write head.
+    // Space is left to the host's transport.
+    if (key.getTextCharacter() == 'z' || key.getTextCharacter() == 'Z')
+    {
+        setPaused(! isPaused());
+        return true;
+    }
+
+    // 'M' shows or hides the minimap strip.
+    if (key.getTextCharacter() == 'm' || key.getTextCharacter() == 'M')
+    {
+        showMinimap = ! showMinimap;
+        updateOpenGLView();
+        repaint();
+        return true;
+    }
+
+    // ']' and '[' jump to the next / previous clip, over or silence and select it.
+    if (key.getTextCharacter() == ']' || key.getTextCharacter() == '[')
+    {
+        jumpToEvent(key.getTextCharacter() == ']');
+        return true;
+    }
+
+    // 'O' replaces the history with an .ssx file.
+    if (key.getTextCharacter() == 'o' || key.getTextCharacter() == 'O')
+    {
+        launchImport();
+        return true;
+    }
+
+    // 'F' toggles the FFT band analysis (shown in the bands lane view).
+    if (key.getTextCharacter() == 'f' || key.getTextCharacter() == 'F')
+    {
+        audioProcessor.setSpectralEnabled(! audioProcessor.isSpectralEnabled());
+        repaint();
+        return true;
+    }
+
+    // 'T' toggles the 4x oversampled true-peak measurement and its layer.
+    if (key.getTextCharacter() == 't' || key.getTextCharacter() == 'T')
+    {
+        audioProcessor.setTruePeakEnabled(! audioProcessor.isTruePeakEnabled());
+        repaint();
+        return true;
+    }
+
+    // 'K' toggles the K-weighted loudness measurement (shown in the loudness lane view).
+    if (key.getTextCharacter() == 'k' || key.getTextCharacter() == 'K')
+    {
+        audioProcessor.setLoudnessEnabled(! audioProcessor.isLoudnessEnabled());
+        repaint();
+        return true;
+    }
+
+    // 'N' toggles broadcasting the levels to SmoothScopeViewer over the network.
+    if (key.getTextCharacter() == 'n' || key.getTextCharacter() == 'N')
+    {
+        audioProcessor.setBroadcastEnabled(! audioProcessor.isBroadcastEnabled());
+        repaint();
+        return true;
+    }
+
+    // 'H' toggles saving the recent history with the plugin state.
+    if (key.getTextCharacter() == 'h' || key.getTextCharacter() == 'H')
+    {
+        saveHistoryInState = ! saveHistoryInState;
+        storeViewState();
+        repaint();
+        return true;
+    }
+
+    return false;
+}
+
+void SmoothScopeAudioProcessorEditor::setZoom (float newZoomX, float newZoomY)
+{
+    zoomX = juce::jlimit(getMinZoomX(), maxZoomX, newZoomX);
+    zoomY = juce::jlimit(minZoomY, maxZoomY, newZoomY);
+
+    storeViewState();
+    updateOpenGLView();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::applyViewState()
+{
+    const auto state = audioProcessor.getViewState();
+    lastStateGeneration = audioProcessor.getStateGeneration();
+
+    zoomX = juce::jlimit(getMinZoomX(), maxZoomX, state.zoomX);
+    zoomY = juce::jlimit(minZoomY, maxZoomY, state.zoomY);
+    laneView = (LaneView)juce::jlimit(0, (int)LaneView::loudness, state.laneView);
+    saveHistoryInState = state.saveHistory;
+
+    scrollCache.invalidate();
+    backgroundRenderer.invalidate();
+    updateOpenGLView();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::storeViewState()
+{
+    audioProcessor.setViewState({ zoomX, zoomY, (int)laneView, saveHistoryInState });
+}
+
+void SmoothScopeAudioProcessorEditor::setBackgroundRenderingEnabled (bool shouldBeEnabled)
+{
+    useBackgroundRender = shouldBeEnabled;
+    backgroundRenderer.invalidate();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::launchExport (bool visibleRangeOnly)
+{
+    // Pin the range now, so it matches what was on screen when the key was pressed
+    HistoryExporter::Options options;
+    options.frameRate = audioProcessor.getFrameRate();
+
+    if (visibleRangeOnly && hasSelection)
+    {
+        options.startFrame = selectionStart;
+        options.endFrame = selectionEnd;
+    }
+    else if (visibleRangeOnly)
+    {
+        options.endFrame = getViewEndFrame();
+        options.startFrame = options.endFrame - (juce::int64)std::ceil((double)getWidth() / (double)zoomX);
+    }
+
+    const auto defaultFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                 .getChildFile("SmoothScope History.ssx");
+
+    exportChooser = std::make_unique<juce::FileChooser>("Export history (.ssx binary or .csv)", defaultFile, "*.ssx;*.csv");
+
+    const auto flags = juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                     | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    exportChooser->launchAsync(flags, [this, options] (const juce::FileChooser& chooser) mutable
+    {
+        const auto file = chooser.getResult();
+
+        if (file == juce::File())
+            return;
+
+        options.file = file;
+        options.format = file.hasFileExtension("csv") ? HistoryExporter::Format::csv : HistoryExporter::Format::binary;
+
+        audioProcessor.getHistoryExporter().start(options);
+        repaint();
+    });
+}
+
+void SmoothScopeAudioProcessorEditor::launchImport()
+{
+    importChooser = std::make_unique<juce::FileChooser>("Open history (.ssx)",
+                                                        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory), "*.ssx");
+
+    importChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                               [this] (const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+
+        if (file == juce::File())
+            return;
+
+        // Read and rebuilt on the importer's thread; the outcome comes back here
+        auto safeThis = juce::Component::SafePointer<SmoothScopeAudioProcessorEditor>(this);
+
+        const bool started = audioProcessor.getHistoryImporter().start(file, [safeThis] (const HistoryImporter::Outcome& outcome)
+        {
+            if (safeThis != nullptr)
+                safeThis->showImportOutcome(outcome);
+        });
+
+        fileStatus = started ? "Opening " + file.getFileName() + "..." : juce::String("Open failed: an import is already running");
+        ++fileStatusChanges;
+        repaint();
+    });
+}
+
+void SmoothScopeAudioProcessorEditor::showImportOutcome(const HistoryImporter::Outcome& outcome)
+{
+    const auto& result = outcome.result;
+    fileStatus = result.wasOk() ? "Opened " + outcome.file.getFileName() : "Open failed: " + result.getErrorMessage();
+
+    // Frames are shown at the processor's rate; say so if the file was made at another one
+    if (result.wasOk() && std::abs(outcome.frameRate - audioProcessor.getFrameRate()) > 0.01)
+        fileStatus += " (recorded at " + juce::String(outcome.frameRate, 2) + " frames/s)";
+
+    // Only the newest HistoryStore::historySize frames (~2.9 h) are loaded; say how much did not fit
+    if (result.wasOk() && outcome.numSkipped > 0)
+    {
+        const double rate = outcome.frameRate > 0.0 ? outcome.frameRate : audioProcessor.getFrameRate();
+        const double minutes = (double)outcome.numSkipped / rate / 60.0;
+        fileStatus += " (oldest " + juce::String(minutes, 1) + " min left out: longer than the history)";
+    }
+
+    ++fileStatusChanges;
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::updateExportStatus()
+{
+    const auto& exporter = audioProcessor.getHistoryExporter();
+    const bool exporting = exporter.isExporting();
+
+    // Tick the progress readout over while an export runs, and show the outcome once
+    if (exporting && (exportVBlanks++ % diagnosticsVBlankDivider) == 0)
+        repaint();
+
+    if (wasExporting && ! exporting)
+    {
+        const auto result = exporter.getLastResult();
+        fileStatus = result.wasOk() ? "Exported " + (exportChooser != nullptr ? exportChooser->getResult().getFileName() : juce::String())
+                                      : "Export failed: " + result.getErrorMessage();
+        ++fileStatusChanges;
+        repaint();
+    }
+
+    wasExporting = exporting;
+}
+
+void SmoothScopeAudioProcessorEditor::updateOpenGLView()
+{
+    // The minimap sits on top, so the detail view is the bottom of the GL surface
+    openGLRenderer.setView(getWidth(), getDetailBounds().getHeight(), zoomX, zoomY, pausedEndFrame);
 }
 
 void SmoothScopeAudioProcessorEditor::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
 {
     float scrollAmount = wheel.deltaY;
+
+    // Shift + wheel, or a sideways swipe, pans through the history
+    const bool horizontal = std::abs(wheel.deltaX) > std::abs(wheel.deltaY);
+
+    if (event.mods.isShiftDown() || horizontal)
+    {
+        panBy(-(horizontal ? wheel.deltaX : wheel.deltaY) * wheelPanPixels);
+        return;
+    }
     
     if (event.mods.isCommandDown() || event.mods.isCtrlDown())
     {
@@ -277,10 +970,324 @@ void SmoothScopeAudioProcessorEditor::mouseWheelMove(const juce::MouseEvent& eve
             float factor = (scrollAmount > 0) ? 1.1f : 0.9f;
             zoomX *= factor;
         }
-        zoomX = juce::jlimit(minZoomX, maxZoomX, zoomX);
+        zoomX = juce::jlimit(getMinZoomX(), maxZoomX, zoomX);
     }
     
+    storeViewState();
+    updateOpenGLView();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
+{
+    // Clicking or dragging in the minimap moves the detail view there
+    draggingMinimap = showMinimap && getMinimapBounds().contains(event.getPosition());
+
+    if (draggingMinimap)
+    {
+        scrubMinimap(event.position.x);
+        return;
+    }
+
+    // Alt, middle or right drag pans; a plain drag selects
+    panning = event.mods.isAltDown() || event.mods.isMiddleButtonDown() || event.mods.isPopupMenu();
+
+    if (panning)
+    {
+        panAnchorX = event.position.x;
+        panAnchorFrame = getViewEndFrame();
+        return;
+    }
+
+    selectionAnchor = getFrameAt(event.position.x);
+}
+
+void SmoothScopeAudioProcessorEditor::mouseDrag(const juce::MouseEvent& event)
+{
+    if (draggingMinimap)
+    {
+        scrubMinimap(event.position.x);
+        return;
+    }
+
+    if (panning)
+    {
+        // The trace follows the mouse: dragging right brings older frames into view
+        setViewEndFrame(panAnchorFrame - (juce::int64)std::round((event.position.x - panAnchorX) / zoomX));
+        return;
+    }
+
+    const auto frame = getFrameAt(event.position.x);
+
+    selectionStart = juce::jmin(selectionAnchor, frame);
+    selectionEnd = juce::jmax(selectionAnchor, frame) + 1;
+    selectionEventType = -1;
+    updateSelection();
+}
+
+void SmoothScopeAudioProcessorEditor::mouseUp(const juce::MouseEvent& event)
+{
+    if (draggingMinimap)
+    {
+        draggingMinimap = false;
+        return;
+    }
+
+    if (panning)
+    {
+        panning = false;
+        return;
+    }
+
+    if (! event.mouseWasDraggedSinceMouseDown())
+        clearSelection();
+}
+
+juce::int64 SmoothScopeAudioProcessorEditor::getFrameAt(float x) const noexcept
+{
+    // The newest frame shown sits at the right edge
+    return getViewEndFrame() - 1 - (juce::int64)std::floor(((float)getWidth() - x) / zoomX);
+}
+
+juce::int64 SmoothScopeAudioProcessorEditor::getViewFramesAgo() const noexcept
+{
+    // Frames keep arriving underneath a paused view
+    return isPaused() ? juce::jmax((juce::int64)0, historyStore.getPyramid().getNumWritten() - pausedEndFrame) : 0;
+}
+
+void SmoothScopeAudioProcessorEditor::setViewEndFrame(juce::int64 newEndFrame)
+{
+    juce::int64 firstFrame;
+
+    {
+        const juce::ScopedLock sl(historyStore.getLock());
+        firstFrame = historyStore.getFirstFrame();
+    }
+
+    // Back at (or past) the write head: follow it again. Otherwise keep at least one frame on screen.
+    const auto head = historyStore.getNumWritten();
+    const auto newPausedEnd = newEndFrame >= head ? (juce::int64)-1 : juce::jmax(firstFrame + 1, newEndFrame);
+
+    if (newPausedEnd == pausedEndFrame)
+        return;
+
+    pausedEndFrame = newPausedEnd;
+    lastNumWritten = head;
+    updateOpenGLView();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::setPaused(bool shouldBePaused)
+{
+    if (shouldBePaused == isPaused())
+        return;
+
+    // Pausing freezes the frames on screen right now
+    pausedEndFrame = shouldBePaused ? juce::jmax((juce::int64)0, lastNumWritten) : -1;
+    lastNumWritten = historyStore.getNumWritten();
+    updateOpenGLView();
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::panBy(float pixels)
+{
+    // Zoomed in, a small pan is less than a frame; still move by one
+    auto frames = (juce::int64)std::round(pixels / zoomX);
+
+    if (frames == 0 && pixels != 0.0f)
+        frames = pixels > 0.0f ? 1 : -1;
+
+    setViewEndFrame(getViewEndFrame() + frames);
+}
+
+void SmoothScopeAudioProcessorEditor::updateSelection()
+{
+    HistoryStore::RangeStats stats;
+    bool found;
+
+    {
+        const juce::ScopedLock sl(historyStore.getLock());
+        found = historyStore.getRangeStats(selectionStart, selectionEnd, stats);
+    }
+
+    auto dB = [] (float level) { return juce::Decibels::toString(juce::Decibels::gainToDecibels(level), 1); };
+
+    hasSelection = true;
+    const juce::String label = selectionEventType >= 0 ? getEventName(selectionEventType) : "Selection";
+
+    selectionText = found ? label + " " + juce::String((double)stats.numFrames / audioProcessor.getFrameRate(), 2) + " s"
+                            + " | Mean " + dB(stats.meanLevel) + " | RMS " + dB(stats.rms)
+                            + " | Min " + dB(stats.minLevel) + " | Max " + dB(stats.maxLevel) + " | Peak " + dB(stats.peak)
+                          : label + ": no history";
+    ++selectionChanges;
+    repaint();
+}
+
+void SmoothScopeAudioProcessorEditor::clearSelection()
+{
+    if (! hasSelection)
+        return;
+
+    hasSelection = false;
+    ++selectionChanges;
     repaint();
 }
 
-void SmoothScopeAudioProcessorEditor::resized() {}
\ No newline at end of file
+void SmoothScopeAudioProcessorEditor::paintEventMarkers(juce::Graphics& g, juce::int64 endFrame, float zoom,
+                                                        float w, float top, float height)
+{
+    // Clips and overs as ticks along the top, silences as a bar along the bottom.
+    // Events that would land on the pixel just drawn are skipped by binary search
+    // (see EventLog::forEach()), so each type costs at most one query per pixel,
+    // however many events the view covers.
+    const juce::Colour colours[EventLog::numTypes] { juce::Colours::red, juce::Colours::orange, juce::Colours::grey };
+    const auto startFrame = endFrame - (juce::int64)std::ceil((double)w / (double)zoom);
+    const auto framesPerPixel = (juce::int64)std::ceil(1.0 / (double)zoom);
+
+    const juce::ScopedLock sl(historyStore.getLock());
+    const auto& events = historyStore.getEventLog();
+
+    // Overs first, so the clips among them are drawn on top
+    for (const int type : { (int)EventLog::over, (int)EventLog::clip, (int)EventLog::silence })
+    {
+        g.setColour(colours[type]);
+
+        events.forEach(type, startFrame, endFrame, framesPerPixel, [&] (const EventLog::Event& event)
+        {
+            // At least a pixel wide; the events skipped after it end within the next pixel
+            const float x1 = juce::jmax(0.0f, w - (float)(endFrame - event.start) * zoom);
+            const float x2 = juce::jmax(x1 + 1.0f, juce::jmin(w, w - (float)(endFrame - event.end) * zoom));
+
+            if (type == EventLog::silence) g.fillRect(x1, top + height - 3.0f, x2 - x1, 3.0f);
+            else                           g.fillRect(x1, top, x2 - x1, 4.0f);
+        });
+    }
+}
+
+void SmoothScopeAudioProcessorEditor::jumpToEvent(bool forwards)
+{
+    const auto halfSpan = (juce::int64)((double)getWidth() / (double)zoomX * 0.5);
+
+    // Carry on from the event jumped to last, otherwise from the centre of the view
+    const auto from = (hasSelection && selectionEventType >= 0) ? selectionStart : getViewEndFrame() - halfSpan;
+    constexpr int allTypes = (1 << EventLog::numTypes) - 1;
+
+    EventLog::Event event;
+    bool found;
+
+    {
+        const juce::ScopedLock sl(historyStore.getLock());
+        const auto& events = historyStore.getEventLog();
+        found = forwards ? events.findNext(from, allTypes, event) : events.findPrevious(from, allTypes, event);
+    }
+
+    if (! found)
+        return;
+
+    // Centre it and select it, so its statistics show up
+    setViewEndFrame(event.start + halfSpan);
+
+    selectionStart = event.start;
+    selectionEnd = event.end;
+    selectionEventType = event.type;
+    updateSelection();
+}
+
+juce::String SmoothScopeAudioProcessorEditor::getEventName(int type)
+{
+    return type == EventLog::clip ? "Clip" : type == EventLog::over ? "Over" : "Silence";
+}
+
+juce::Rectangle<int> SmoothScopeAudioProcessorEditor::getMinimapBounds() const noexcept
+{
+    return getLocalBounds().withHeight(showMinimap ? minimapHeight : 0);
+}
+
+juce::Rectangle<int> SmoothScopeAudioProcessorEditor::getDetailBounds() const noexcept
+{
+    return getLocalBounds().withTrimmedTop(showMinimap ? minimapHeight : 0);
+}
+
+void SmoothScopeAudioProcessorEditor::paintMinimap (juce::Graphics& g)
+{
+    // ============================================================
+    // MINIMAP: the whole recorded history across the width, with
+    // the detail view marked on it. Its columns are anchored to
+    // absolute frames (see ScrollingImageCache), so new frames only
+    // rasterise the newest column. The span doubles as the history
+    // grows, so the strip is laid out again only a handful of times.
+    // ============================================================
+    const auto bounds = getMinimapBounds();
+
+    if (! g.clipRegionIntersects(bounds))
+        return;
+
+    const float w = (float)bounds.getWidth();
+    juce::int64 head;
+    float zoom;
+
+    {
+        const juce::ScopedLock sl(historyStore.getLock());
+        head = historyStore.getPyramid().getNumWritten();
+
+        while (minimapSpan < head - historyStore.getFirstFrame())
+            minimapSpan *= 2;
+
+        zoom = w / (float)minimapSpan;
+
+        const juce::Graphics::ScopedSaveState state (g);
+        g.reduceClipRegion(bounds);
+        g.setOrigin(bounds.getPosition());
+        g.fillAll(juce::Colours::black);
+
+        const auto plan = LodPlanner::plan(bounds.withZeroOrigin(), bounds.getWidth(), zoom);
+        minimapCache.draw(g, historyStore, bounds.getWidth(), bounds.getHeight(), zoom, 1.0f, plan, head);
+    }
+
+    paintEventMarkers(g, head, zoom, w, (float)bounds.getY(), (float)bounds.getHeight());
+
+    // The detail view, clamped so it stays visible when it is narrower than a pixel
+    const auto viewEnd = getViewEndFrame();
+    const float x2 = w - (float)(head - viewEnd) * zoom;
+    const float x1 = juce::jmin(x2 - 2.0f, x2 - (float)getWidth() / zoomX * zoom);
+
+    g.setColour(juce::Colours::white.withAlpha(0.15f));
+    g.fillRect(juce::jmax(0.0f, x1), (float)bounds.getY(), juce::jmin(w, x2) - juce::jmax(0.0f, x1), (float)bounds.getHeight());
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.drawRect(juce::Rectangle<float>(x1, (float)bounds.getY(), x2 - x1, (float)bounds.getHeight()), 1.0f);
+
+    g.setColour(juce::Colours::darkgrey);
+    g.drawHorizontalLine(bounds.getBottom() - 1, 0.0f, w);
+}
+
+void SmoothScopeAudioProcessorEditor::scrubMinimap(float x)
+{
+    // Centre the detail view on the frame under the mouse
+    const auto frame = historyStore.getNumWritten() - (juce::int64)(((float)getWidth() - x) * (float)minimapSpan / (float)getWidth());
+    setViewEndFrame(frame + (juce::int64)((double)getWidth() / (double)zoomX * 0.5));
+}
+
+void SmoothScopeAudioProcessorEditor::resized()
+{
+    // The raw zone never needs more than one sample per pixel (plus slack), the
+    // envelope one column per pixel, so size everything paint() uses up front.
+    reserveScratch(getWidth() + 3, getWidth() + 1);
+    updateOpenGLView();
+}
+
+void SmoothScopeAudioProcessorEditor::reserveScratch (int numSamples, int numColumns)
+{
+    const auto samples = (size_t)juce::jmax(numSamples, (int)rawValues.size());
+    rawValues.resize(samples);
+    rawPeakValues.resize(samples);
+    yValues.resize(samples);
+    yPeakValues.resize(samples);
+
+    envelope.reserve(numColumns);
+
+    // Each lineTo() adds three floats; the fill path runs along both edges
+    tracePath.preallocateSpace(3 * (int)samples);
+    tracePeakPath.preallocateSpace(3 * (int)samples);
+    envelopeFillPath.preallocateSpace(6 * numColumns + 8);
+    envelopePeakPath.preallocateSpace(3 * numColumns);
+}
\ No newline at end of file
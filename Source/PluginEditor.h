@@ -2,16 +2,17 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "MinMaxPyramid.h"
+#include "ColumnEnvelope.h"
+#include "LodPlanner.h"
+#include "OpenGLScopeRenderer.h"
+#include "ScrollingImageCache.h"
+#include "BackgroundScopeRenderer.h"
+#include "HistoryPrefetcher.h"
+#include "AllocationCounter.h"
+#include "NumberReadout.h"
 
-// Simple struct to hold both peak and valley for a time range
-struct MinMax
-{
-    float min;
-    float max;
-};
-
-class SmoothScopeAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                        public juce::Timer
+class SmoothScopeAudioProcessorEditor : public juce::AudioProcessorEditor
 {
 public:
     SmoothScopeAudioProcessorEditor (SmoothScopeAudioProcessor&);
@@ -19,49 +20,204 @@ public:
 
     void paint (juce::Graphics&) override;
     void resized() override;
-    void timerCallback() override;
     void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+    void mouseDown(const juce::MouseEvent& event) override;
+    void mouseDrag(const juce::MouseEvent& event) override;
+    void mouseUp(const juce::MouseEvent& event) override;
+    bool keyPressed (const juce::KeyPress& key) override;
+
+    // View controls for code that drives the editor programmatically (benchmarks, state restore)
+    void setZoom (float newZoomX, float newZoomY);
+    float getZoomX() const noexcept { return zoomX; }
+    float getZoomY() const noexcept { return zoomY; }
+    void setBackgroundRenderingEnabled (bool shouldBeEnabled);
 
 private:
     SmoothScopeAudioProcessor& audioProcessor;
 
-    // --- 1. RAW BUFFER (High Detail) ---
-    // 1 Million samples ~ 3 hours.
-    static constexpr int historySize = 1048576; 
-    std::vector<float> historyBuffer;
-    int historyWriteIndex = 0;
+    // --- HISTORY (Raw + Min/Max Pyramid) ---
+    // Owned by the processor; the editor is only a read-only view onto it.
+    // The pyramid keeps 4x, 16x, 64x ... decimated Min/Max levels on top of the
+    // raw ring, so any pixel column can be reduced in O(log N) regardless of zoom.
+    HistoryStore& historyStore;
+    juce::int64 lastNumWritten = -1; // frames shown by the last repaint
+    int lastGeneration = 0;
+
+    // Column reduction, raw-zone scratch and paths, sized in resized() and reused
+    // across paints so steady-state scrolling stays off the heap.
+    ColumnEnvelope envelope;
+    std::vector<float> rawValues, rawPeakValues, yValues, yPeakValues;
+    juce::Path tracePath, tracePeakPath, envelopeFillPath, envelopePeakPath;
+    void reserveScratch (int numSamples, int numColumns);
+
+    // Heap allocations made by the previous paint (only counted if SMOOTHSCOPE_COUNT_ALLOCATIONS).
+    // Drawn from cached digits rather than in the overlay text: laying that out again
+    // for every new count would allocate and change the count it shows.
+    juce::int64 lastPaintAllocations = 0;
+    NumberReadout allocationReadout;
+    void paintScope (juce::Graphics& g);
+
+    // --- Diagnostics overlay (toggle with 'D'), fed by ScopeStats ---
+    bool showDiagnostics = false;
+    int paintedZone = ScopeStats::rawZone; // set by paintScope() for the paint timing
+    int pointsEmitted = 0;
+    static constexpr int diagnosticsVBlankDivider = 15;
+    int diagnosticsVBlanks = 0;
+    void paintDiagnostics (juce::Graphics& g);
+
+    // --- Optional cached-image scrolling (toggle with 'C') ---
+    ScrollingImageCache scrollCache;
+    bool useScrollCache = false;
+
+    // --- Envelope zones rendered off the message thread (toggle with 'B') ---
+    BackgroundScopeRenderer backgroundRenderer;
+    bool useBackgroundRender = true;
+
+    // --- Optional GPU path (toggle with 'G') ---
+    OpenGLScopeRenderer openGLRenderer;
+    void updateOpenGLView();
+    void paintOverlay (juce::Graphics& g);
+
+    // Overlay text is laid out again only when something it shows changes
+    struct OverlayState
+    {
+        float zoomX = 0.0f;
+        int laneView = 0;
+        bool openGL = false, scrollCache = false, background = false, persistence = false;
+        int exportPercent = -1, fileStatusChanges = 0, selectionChanges = 0;
+        bool savedHistory = false, truePeak = false, loudness = false, broadcast = false;
+        juce::int64 pausedEndFrame = -1;
+        juce::int64 numEvents = 0;
+        bool diskFailed = false;
+
+        bool operator== (const OverlayState& other) const noexcept
+        {
+            return zoomX == other.zoomX && laneView == other.laneView
+                && openGL == other.openGL && scrollCache == other.scrollCache && background == other.background
+                && persistence == other.persistence
+                && exportPercent == other.exportPercent && fileStatusChanges == other.fileStatusChanges
+                && selectionChanges == other.selectionChanges
+                && savedHistory == other.savedHistory && truePeak == other.truePeak && loudness == other.loudness
+                && broadcast == other.broadcast && pausedEndFrame == other.pausedEndFrame
+                && numEvents == other.numEvents && diskFailed == other.diskFailed;
+        }
+    };
 
-    // --- 2. OVERVIEW BUFFER (Min/Max) ---
-    // Stores Min/Max pairs to preserve down-peaks (silence) when zoomed out.
-    static constexpr int decimationFactor = 64;
-    static constexpr int overviewSize = historySize / decimationFactor;
-    std::vector<MinMax> overviewBuffer;
-    int overviewWriteIndex = 0;
+    OverlayState overlayState;
+    juce::GlyphArrangement overlayText;
 
-    // Accumulators for generating the overview
-    float currentOverviewMax = 0.0f;
-    float currentOverviewMin = 10.0f; // Start high so first sample overwrites it
-    int currentOverviewCounter = 0;
+    // --- History export ('E' = everything, Shift+E = selection, else visible range) and import ('O') ---
+    // Exports run on the processor's HistoryExporter; the overlay shows progress and the outcome.
+    // Imports read an .ssx file (e.g. from SmoothScopeAnalyze) and replace the history.
+    std::unique_ptr<juce::FileChooser> exportChooser, importChooser;
+    bool wasExporting = false;
+    int exportVBlanks = 0;
+    int fileStatusChanges = 0;
+    juce::String fileStatus;
+    void launchExport (bool visibleRangeOnly);
+    void launchImport();
+    void showImportOutcome(const HistoryImporter::Outcome& outcome);
+    void updateExportStatus();
+
+    // --- Range selection (drag across the trace, click to clear) ---
+    // Kept in absolute frames so it scrolls with the data. Its statistics come from
+    // HistoryStore::getRangeStats() and are only worked out when the selection changes.
+    bool hasSelection = false;
+    juce::int64 selectionAnchor = 0, selectionStart = 0, selectionEnd = 0;
+    int selectionChanges = 0;
+    int selectionEventType = -1; // EventLog::Type if the selection is an event jumped to
+    juce::String selectionText;
+    juce::int64 getFrameAt(float x) const noexcept;
+    void updateSelection();
+    void clearSelection();
+
+    // --- Pan and pause ('Z'; Alt, middle or right drag and Shift + wheel pan) ---
+    // A paused view keeps its right edge on an absolute frame while recording carries
+    // on underneath. Panning away from the write head pauses, panning back onto it
+    // follows the head again. The prefetcher pages in the disk history on both sides
+    // of the view meanwhile, so scrubbing through it does not stall paint().
+    juce::int64 pausedEndFrame = -1; // frame just past the right edge while paused, -1 = live
+    bool panning = false;
+    float panAnchorX = 0.0f;
+    juce::int64 panAnchorFrame = 0;
+    HistoryPrefetcher prefetcher;
+    bool isPaused() const noexcept { return pausedEndFrame >= 0; }
+    juce::int64 getViewEndFrame() const noexcept { return isPaused() ? pausedEndFrame : lastNumWritten; }
+    juce::int64 getViewFramesAgo() const noexcept; // call with the history lock held
+    void setViewEndFrame(juce::int64 newEndFrame);
+    void setPaused(bool shouldBePaused);
+    void panBy(float pixels);
+
+    // --- Minimap (toggle with 'M') ---
+    // A strip along the top with the whole history, drawn from the same pyramid as the
+    // detail view below it; click or drag in it to move the detail view. It keeps its
+    // own ScrollingImageCache, so as frames arrive only its newest column is redrawn.
+    // History older than the RAM ring comes from the disk's chunk summaries alone, so
+    // a full redraw of the strip never maps chunk files on the paint thread.
+    static constexpr int minimapHeight = 48;
+    static constexpr juce::int64 minimapMinSpan = 1 << 14; // frames, ~3 minutes at the 10 ms hop
+    bool showMinimap = true;
+    bool draggingMinimap = false;
+    juce::int64 minimapSpan = minimapMinSpan; // frames across the strip, doubles as the history grows
+    ScrollingImageCache minimapCache;
+    juce::Rectangle<int> getMinimapBounds() const noexcept;
+    juce::Rectangle<int> getDetailBounds() const noexcept; // everything below the minimap
+    void paintMinimap (juce::Graphics& g);
+    void scrubMinimap(float x);
+
+    // --- Events (see EventLog) ---
+    // Markers in both views come from range queries on the processor's event index.
+    // ']' / '[' jump to the next / previous event and select it.
+    void paintEventMarkers(juce::Graphics& g, juce::int64 endFrame, float zoom, float w, float top, float height);
+    void jumpToEvent(bool forwards);
+    static juce::String getEventName(int type);
+
+    // --- Saved view (see SmoothScopeAudioProcessor::ViewState) ---
+    // 'H' toggles whether the recent history is saved with the project too.
+    bool saveHistoryInState = false;
+    int lastStateGeneration = 0;
+    void applyViewState();
+    void storeViewState();
+
+    // --- Per-channel lanes, spectral bands and loudness (cycle with 'L') ---
+    enum class LaneView { mix, stacked, overlaid, bands, loudness };
+    LaneView laneView = LaneView::mix;
+    juce::StringArray laneNames; // cached channel names
+    void paintLanes (juce::Graphics& g);
+
+    // One pixel per column and band, stretched over the editor (toggle the analysis with 'F')
+    juce::Image bandImage;
+    void paintBands (juce::Graphics& g);
+
+    // Momentary and short-term lanes with an M / S / I readout (toggle the measurement with 'K').
+    // The readout is laid out again only when a reading moves by 0.1 LU.
+    juce::GlyphArrangement loudnessReadout;
+    int loudnessTenths[3] {};
+    void paintLoudness (juce::Graphics& g);
+
+    // What the current paint draws (see LodPlanner)
+    LodPlan lodPlan;
 
     // --- Zoom Parameters ---
     float zoomX = 5.0f;
     float zoomY = 1.0f;
 
     const float minZoomX = 0.0001f;
+    const float minPersistentZoomX = 0.0000001f; // disk-backed history: zoom out to years
+    float getMinZoomX() const { return historyStore.isPersistenceEnabled() ? minPersistentZoomX : minZoomX; }
     const float maxZoomX = 50.0f;
     const float minZoomY = 0.5f;
     const float maxZoomY = 10.0f;
-    
-    // Helper to get safe index from circular buffer
-    template <typename T>
-    T getSample(const std::vector<T>& buffer, int writeIndex, int samplesAgo) const
-    {
-        int idx = writeIndex - 1 - samplesAgo;
-        int size = (int)buffer.size();
-        while (idx < 0) idx += size;
-        while (idx >= size) idx -= size;
-        return buffer[idx];
-    }
+    const float wheelPanPixels = 256.0f; // per unit of wheel delta
 
+    // --- Refresh (display vsync) ---
+    // Repaints are driven by the display rather than a fixed timer, and skipped
+    // until new data scrolls the trace by at least a pixel (see onVBlank()).
+    // Declared last so it is detached before anything it calls is destroyed.
+    void onVBlank();
+    static constexpr int backgroundVBlankDivider = 4; // refresh rate divider while the host is in the background
+    int backgroundVBlanks = 0;
+    juce::VBlankAttachment vBlankAttachment { this, [this] { onVBlank(); } };
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoothScopeAudioProcessorEditor)
 };
\ No newline at end of file
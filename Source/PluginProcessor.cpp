@@ -9,26 +9,131 @@ SmoothScopeAudioProcessor::SmoothScopeAudioProcessor()
 
 SmoothScopeAudioProcessor::~SmoothScopeAudioProcessor() {}
 
-void SmoothScopeAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock) {}
+void SmoothScopeAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Frames are emitted on a fixed 10 ms hop, whatever block size the host uses.
+    levelAnalyser.prepare (sampleRate);
+    levelAnalyser.setChannelLayout (getChannelLayoutOfBus (true, 0));
+    levelPublisher.setFrameRate (levelAnalyser.getFrameRate());
+    spectralTap.reset (sampleRate);
+}
 
 void SmoothScopeAudioProcessor::releaseResources() {}
 
+bool SmoothScopeAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    // Any layout works (mono, stereo, 7.1.4, ambisonics ...) as long as audio passes
+    // straight through; only the first LevelFrame::maxChannels channels get their own lane.
+    const auto input = layouts.getMainInputChannelSet();
+
+    return ! input.isDisabled() && input == layouts.getMainOutputChannelSet();
+}
+
 void SmoothScopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     
-    // Note: RMS is smooth, but if you want to catch sudden peaks (transients) 
-    // better, buffer.getMagnitude(0, numSamples) is often preferred for scopes.
-    // However, sticking to your RMS logic as requested:
-    float rms = buffer.getRMSLevel(0, 0, buffer.getNumSamples());
-    
-    if (getTotalNumInputChannels() > 1)
-    {
-        float rightRms = buffer.getRMSLevel(1, 0, buffer.getNumSamples());
-        rms = (rms + rightRms) * 0.5f;
-    }
+    // RMS is smooth but misses sudden peaks (transients), so the fused kernel
+    // measures RMS, peak and minimum of all input channels in a single pass.
+    // Values are accumulated across blocks and one frame is pushed per hop.
+    const int numChannels = juce::jmin (getTotalNumInputChannels(), buffer.getNumChannels());
+
+    // The band analysis runs on the history thread, from a tap that is written
+    // before the frames whose windows it holds are pushed.
+    const bool bands = isSpectralEnabled();
+
+    if (bands) spectralTap.write (buffer.getArrayOfReadPointers(), numChannels, buffer.getNumSamples());
+    else       spectralTap.skip (buffer.getNumSamples());
+
+    levelAnalyser.process (buffer.getArrayOfReadPointers(), numChannels, buffer.getNumSamples(),
+                           [this, bands] (const LevelFrame& frame)
+                           {
+                               auto tagged = frame;
+                               tagged.hasBands = bands;
+                               pushToFifo (tagged);
+                           });
 
-    pushToFifo(rms);
+    const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+    stats.processBlockTime.record (juce::Time::highResolutionTicksToSeconds (elapsed) * 1.0e6);
+}
+
+ScopeStats::Snapshot SmoothScopeAudioProcessor::getStatsSnapshot() const noexcept
+{
+    auto snapshot = stats.getSnapshot();
+    snapshot.fifoFill = fifo.getNumReady();
+    snapshot.fifoCapacity = fifoSize;
+    return snapshot;
+}
+
+SmoothScopeAudioProcessor::ViewState SmoothScopeAudioProcessor::getViewState() const noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (viewStateLock);
+    return viewState;
+}
+
+void SmoothScopeAudioProcessor::setViewState (const ViewState& newState) noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (viewStateLock);
+    viewState = newState;
+}
+
+void SmoothScopeAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    const auto state = getViewState();
+
+    juce::MemoryOutputStream out (destData, false);
+    out.writeInt (stateMagic);
+    out.writeInt (stateVersion);
+    out.writeFloat (state.zoomX);
+    out.writeFloat (state.zoomY);
+    out.writeInt (state.laneView);
+    out.writeBool (state.saveHistory);
+    out.writeBool (isTruePeakEnabled());
+    out.writeBool (isSpectralEnabled());
+    out.writeBool (isLoudnessEnabled());
+    out.writeBool (isBroadcastEnabled());
+
+    // Only the newest block is encoded per save; completed ones come from a cache
+    if (state.saveHistory)
+        savedHistory.write (out);
+}
+
+void SmoothScopeAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    juce::MemoryInputStream in (data, (size_t) sizeInBytes, false);
+
+    if (in.readInt() != stateMagic)
+        return;
+
+    const int version = in.readInt();
+
+    if (version > stateVersion)
+        return;
+
+    ViewState state;
+    state.zoomX = in.readFloat();
+    state.zoomY = in.readFloat();
+    state.laneView = in.readInt();
+    state.saveHistory = in.readBool();
+    setTruePeakEnabled (version >= 2 && in.readBool());
+    setSpectralEnabled (version >= 3 && in.readBool());
+    setLoudnessEnabled (version >= 4 && in.readBool());
+    setBroadcastEnabled (version >= 5 && in.readBool());
+
+    setViewState (state);
+
+    // A truncated or corrupt history block leaves the current history as it is
+    if (state.saveHistory && ! in.isExhausted())
+        SavedHistory::read (in, historyStore);
+
+    ++stateGeneration;
+}
+
+void SmoothScopeAudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    if (properties.name.has_value() && properties.name->isNotEmpty())
+        levelPublisher.setStreamName (*properties.name);
 }
 
 juce::AudioProcessorEditor* SmoothScopeAudioProcessor::createEditor()
@@ -1,6 +1,15 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "HistoryStore.h"
+#include "HistoryExporter.h"
+#include "HistoryImporter.h"
+#include "SavedHistory.h"
+#include "LevelAnalyser.h"
+#include "SpscRing.h"
+#include "ScopeStats.h"
+#include "SpectralAnalyser.h"
+#include "LevelPublisher.h"
 
 class SmoothScopeAudioProcessor : public juce::AudioProcessor
 {
@@ -10,6 +19,7 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
@@ -27,27 +37,112 @@ public:
     const juce::String getProgramName (int index) override { return {}; }
     void changeProgramName (int index, const juce::String& newName) override {}
 
-    void getStateInformation (juce::MemoryBlock& destData) override {}
-    void setStateInformation (const void* data, int sizeInBytes) override {}
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    // Names the broadcast stream after the host's track
+    void updateTrackProperties (const TrackProperties& properties) override;
 
     // --- Data Exchange ---
+    // Audio thread -> history thread. One frame per analysis hop.
     static constexpr int fifoSize = 1024;
-    float fifoBuffer[fifoSize];
-    std::atomic<int> fifoWriteIndex { 0 };
-    std::atomic<int> fifoReadIndex { 0 };
+    SpscRing<LevelFrame, fifoSize> fifo;
 
-    void pushToFifo(float rmsValue)
+    void pushToFifo(const LevelFrame& frame)
     {
-        int currentWrite = fifoWriteIndex.load(std::memory_order_acquire);
-        int nextWrite = (currentWrite + 1) % fifoSize;
-
-        if (nextWrite != fifoReadIndex.load(std::memory_order_acquire))
-        {
-            fifoBuffer[currentWrite] = rmsValue;
-            fifoWriteIndex.store(nextWrite, std::memory_order_release);
-        }
+        // A full ring drops the frame; count it instead of losing it silently
+        if (fifo.push(frame)) addRelaxed(stats.framesPushed, (juce::int64) 1);
+        else                  addRelaxed(stats.framesDropped, (juce::int64) 1);
     }
 
+    // --- Diagnostics ---
+    ScopeStats& getStats() noexcept { return stats; }
+    ScopeStats::Snapshot getStatsSnapshot() const noexcept;
+
+    // --- History ---
+    // Lives as long as the processor, so closing and reopening the editor keeps the timeline.
+    HistoryStore& getHistoryStore() noexcept { return historyStore; }
+
+    // Background export of the RAM history to a file.
+    HistoryExporter& getHistoryExporter() noexcept { return historyExporter; }
+
+    // Background load of an .ssx file into the history.
+    HistoryImporter& getHistoryImporter() noexcept { return historyImporter; }
+
+    // --- Saved State ---
+    // What the editor shows, kept here so it survives closing the editor and is saved
+    // with the project. The editor writes it back whenever the view changes.
+    struct ViewState
+    {
+        float zoomX = 5.0f;
+        float zoomY = 1.0f;
+        int laneView = 0;
+        bool saveHistory = false; // also store the recent history (see SavedHistory)
+    };
+
+    ViewState getViewState() const noexcept;
+    void setViewState (const ViewState& newState) noexcept;
+
+    // Bumped by setStateInformation(), so an open editor knows to pick up the restored view
+    int getStateGeneration() const noexcept { return stateGeneration.load (std::memory_order_acquire); }
+
+    // --- True Peak ---
+    // 4x oversampled peak per hop (see TruePeakDetector), saved with the state. Any thread.
+    void setTruePeakEnabled (bool shouldBeEnabled) noexcept { levelAnalyser.setTruePeakEnabled (shouldBeEnabled); }
+    bool isTruePeakEnabled() const noexcept { return levelAnalyser.isTruePeakEnabled(); }
+
+    // --- Loudness ---
+    // K-weighted BS.1770 energy per hop (see LevelAnalyser), turned into momentary,
+    // short-term and integrated LUFS on the history thread (see LoudnessMeter).
+    // Saved with the state. Any thread.
+    void setLoudnessEnabled (bool shouldBeEnabled) noexcept { levelAnalyser.setLoudnessEnabled (shouldBeEnabled); }
+    bool isLoudnessEnabled() const noexcept { return levelAnalyser.isLoudnessEnabled(); }
+
+    // --- Spectral Bands ---
+    // Mono tap of the input for the history thread's band analysis; it is only
+    // written while band analysis is on. Any thread.
+    void setSpectralEnabled (bool shouldBeEnabled) noexcept { spectralEnabled.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isSpectralEnabled() const noexcept { return spectralEnabled.load (std::memory_order_relaxed); }
+    const SpectralAnalyser::Tap& getSpectralTap() const noexcept { return spectralTap; }
+
+    // --- Broadcast ---
+    // Sends the mix levels to SmoothScopeViewer (see LevelPublisher), saved with the state.
+    // Any thread (setStateInformation() restores it wherever the host calls it).
+    void setBroadcastEnabled (bool shouldBeEnabled) { levelPublisher.setEnabled (shouldBeEnabled); }
+    bool isBroadcastEnabled() const noexcept { return levelPublisher.isEnabled(); }
+    LevelPublisher& getLevelPublisher() noexcept { return levelPublisher; }
+
+    // Fixed-hop frame rate (frames per second) of everything pushed to the FIFO.
+    double getFrameRate() const noexcept { return levelAnalyser.getFrameRate(); }
+
 private:
+    LevelAnalyser levelAnalyser;
+    ScopeStats stats;
+
+    SpectralAnalyser::Tap spectralTap;
+    std::atomic<bool> spectralEnabled { false };
+
+    // Fed by the history thread, so it has to outlive historyStore
+    LevelPublisher levelPublisher;
+
+    // Declared after the FIFO so it is destroyed (and its consumer thread stopped) first.
+    HistoryStore historyStore { *this };
+
+    // Use historyStore, so they go (and the export / import threads stop) before it.
+    HistoryExporter historyExporter { historyStore };
+    HistoryImporter historyImporter { historyStore };
+    SavedHistory savedHistory { historyStore };
+
+    // Hosts may save and load state on any thread
+    mutable juce::SpinLock viewStateLock;
+    ViewState viewState;
+    std::atomic<int> stateGeneration { 0 };
+
+    // Binary state layout: magic "SSS1", version, then the ViewState fields, the
+    // true-peak (version 2), band analysis (version 3), loudness (version 4) and
+    // broadcast (version 5) switches and, if saveHistory is set, a SavedHistory block.
+    static constexpr int stateMagic = 0x31535353; // "SSS1"
+    static constexpr int stateVersion = 5;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SmoothScopeAudioProcessor)
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularHistory.h"
+
+// Running (prefix) sums over a circular history, for O(1) sums of any range.
+//
+// Slot i holds the sum of every value before absolute position i, so the sum over
+// [start, end) is one subtraction, with the running total standing in for the
+// end of the history. Old slots are overwritten as the ring wraps, exactly like
+// the MinMaxPyramid next to it, and ranges are clipped to what is still retained.
+//
+// The running total is accumulated with Kahan compensation in double precision,
+// so it does not drift no matter how many values are pushed; the precision of a
+// range sum is that of the total at its ends.
+class PrefixSum
+{
+public:
+    // capacity must be a power of two.
+    explicit PrefixSum (int capacity) : before (capacity) {}
+
+    void push (double value) noexcept
+    {
+        before.push (total);
+
+        const double y = value - compensation;
+        const double t = total + y;
+        compensation = (t - total) - y;
+        total = t;
+    }
+
+    void clear() noexcept
+    {
+        before.clear();
+        total = compensation = 0.0;
+    }
+
+    juce::int64 getNumWritten() const noexcept { return before.getNumWritten(); }
+    juce::int64 getOldest() const noexcept { return before.getOldest(); }
+
+    // Sum over the absolute positions [start, end), clipped to the retained history.
+    // numValues receives the number of values that were summed.
+    double getSum (juce::int64 start, juce::int64 end, juce::int64& numValues) const noexcept
+    {
+        start = juce::jmax (start, before.getOldest());
+        end = juce::jmin (end, before.getNumWritten());
+
+        if (start >= end)
+        {
+            numValues = 0;
+            return 0.0;
+        }
+
+        numValues = end - start;
+        const double endSum = (end == before.getNumWritten()) ? total : before[end];
+        return endSum - before[start];
+    }
+
+    size_t getMemoryUsage() const noexcept { return (size_t) before.getCapacity() * sizeof (double); }
+
+private:
+    CircularHistory<double> before;
+    double total = 0.0, compensation = 0.0;
+};
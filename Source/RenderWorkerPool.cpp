@@ -0,0 +1,161 @@
+#include "RenderWorkerPool.h"
+
+class RenderWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker (RenderWorkerPool& ownerToUse, int index)
+        : juce::Thread ("SmoothScope Render " + juce::String (index)), owner (ownerToUse) {}
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (auto* client = owner.takeNext())
+            {
+                client->renderPending();
+                owner.finished (*client);
+            }
+            else
+            {
+                wait (-1); // woken by schedule() or the destructor
+            }
+        }
+    }
+
+private:
+    RenderWorkerPool& owner;
+};
+
+RenderWorkerPool::RenderWorkerPool()
+{
+    // Leave a core for the message thread
+    const int numWorkers = juce::jmax (1, juce::SystemStats::getNumCpus() - 1);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, i));
+        workers.back()->startThread();
+    }
+}
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    wakeWorkers();
+
+    for (auto& worker : workers)
+        worker->stopThread (2000);
+
+    // Every client must have removed itself by now
+    jassert (queue.isEmpty());
+}
+
+void RenderWorkerPool::schedule (Client& client)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (client.running)
+        {
+            client.rerun = true;
+            return; // finished() queues it again
+        }
+
+        if (client.queued)
+            return;
+
+        client.queued = true;
+        queue.add (&client);
+    }
+
+    wakeWorkers();
+}
+
+void RenderWorkerPool::remove (Client& client)
+{
+    const juce::ScopedLock sl (lock);
+
+    queue.removeFirstMatchingValue (&client);
+    client.queued = false;
+    client.rerun = false;
+
+    while (client.running)
+    {
+        const juce::ScopedUnlock su (lock);
+        juce::Thread::sleep (1);
+    }
+
+    // A rerun may have been requested while we waited
+    queue.removeFirstMatchingValue (&client);
+    client.queued = false;
+    client.rerun = false;
+}
+
+void RenderWorkerPool::parallelFor (int numTasks, const std::function<void (int)>& task)
+{
+    // Every helper, and the caller, keeps claiming the next index until none are left
+    struct Helper : public Client
+    {
+        Helper (std::atomic<int>& n, int num, const std::function<void (int)>& t) : next (n), numTasks (num), task (t) {}
+
+        void renderPending() override
+        {
+            for (int i = next++; i < numTasks; i = next++)
+                task (i);
+        }
+
+        std::atomic<int>& next;
+        const int numTasks;
+        const std::function<void (int)>& task;
+    };
+
+    std::atomic<int> next { 0 };
+    juce::OwnedArray<Helper> helpers;
+
+    for (int i = 0; i < juce::jmin (getNumWorkers(), numTasks - 1); ++i)
+        schedule (*helpers.add (new Helper (next, numTasks, task)));
+
+    Helper (next, numTasks, task).renderPending();
+
+    // Helpers that never got a worker are simply dropped; running ones are waited for
+    for (auto* helper : helpers)
+        remove (*helper);
+}
+
+RenderWorkerPool::Client* RenderWorkerPool::takeNext()
+{
+    const juce::ScopedLock sl (lock);
+
+    if (queue.isEmpty())
+        return nullptr;
+
+    auto* client = queue.removeAndReturn (0);
+    client->queued = false;
+    client->running = true;
+    return client;
+}
+
+void RenderWorkerPool::finished (Client& client)
+{
+    {
+        const juce::ScopedLock sl (lock);
+        client.running = false;
+
+        if (! client.rerun)
+            return;
+
+        client.rerun = false;
+        client.queued = true;
+        queue.add (&client);
+    }
+
+    wakeWorkers();
+}
+
+void RenderWorkerPool::wakeWorkers()
+{
+    for (auto& worker : workers)
+        worker->notify();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// A process-wide pool of render threads shared by every SmoothScope editor.
+//
+// Hold it through a juce::SharedResourcePointer<RenderWorkerPool>: the first
+// editor to open creates the pool, the last one to close destroys it. It runs
+// one thread per core (minus one for the message thread), however many
+// instances are open, so a big session no longer queues all of its envelope
+// work on the message thread.
+class RenderWorkerPool
+{
+public:
+    // Something that has rendering work to do. A client is never run on two
+    // workers at once; scheduling it while it runs queues exactly one re-run.
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Called on a worker thread.
+        virtual void renderPending() = 0;
+
+    private:
+        friend class RenderWorkerPool;
+        bool queued = false, running = false, rerun = false;
+    };
+
+    RenderWorkerPool();
+    ~RenderWorkerPool();
+
+    int getNumWorkers() const noexcept { return (int) workers.size(); }
+
+    // Queues the client unless it is already waiting; never blocks.
+    void schedule (Client& client);
+
+    // Drops the client from the queue and waits for a running render to finish.
+    // Must be called before the client is destroyed.
+    void remove (Client& client);
+
+    // Runs task (i) for every i in [0, numTasks) across the workers and the calling
+    // thread, and returns once all of them are done. Meant for bulk work such as a
+    // pyramid rebuild; tasks should be coarse (thousands of elements each).
+    void parallelFor (int numTasks, const std::function<void (int)>& task);
+
+private:
+    class Worker;
+
+    Client* takeNext();
+    void finished (Client& client);
+    void wakeWorkers();
+
+    juce::CriticalSection lock;
+    juce::Array<Client*> queue;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderWorkerPool)
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lossy single-producer / single-consumer ring of mono samples for analysis that
+// runs off the audio thread (see SpectralAnalyser).
+//
+// Unlike SpscRing the writer never waits or drops: it always overwrites the
+// oldest samples, and every sample has an absolute position (samples since
+// reset()) that matches LevelAnalyser's count. Readers ask for a window by
+// position and are told if any of it is not, or no longer, in the ring.
+template <int Capacity>
+class SampleTap
+{
+public:
+    static_assert (Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static constexpr int capacity = Capacity;
+
+    // --- Audio thread ---
+    void reset (double newSampleRate) noexcept
+    {
+        sampleRate.store (newSampleRate, std::memory_order_relaxed);
+        validFrom.store (0, std::memory_order_relaxed);
+        writePos.store (0, std::memory_order_release);
+        writing = false;
+    }
+
+    // Appends the average of the channels.
+    void write (const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        auto pos = writePos.load (std::memory_order_relaxed);
+
+        // After a gap (see skip()) only what is written from here on is valid
+        if (! writing)
+        {
+            validFrom.store (pos, std::memory_order_relaxed);
+            writing = true;
+        }
+
+        const float gain = numChannels > 0 ? 1.0f / (float) numChannels : 0.0f;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int slot = (int) (pos & mask);
+            const int count = juce::jmin (numSamples - done, capacity - slot);
+
+            if (numChannels == 0)
+                juce::FloatVectorOperations::clear (data + slot, count);
+            else
+                juce::FloatVectorOperations::copyWithMultiply (data + slot, channels[0] + done, gain, count);
+
+            for (int ch = 1; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply (data + slot, channels[ch] + done, gain, count);
+
+            done += count;
+            pos += count;
+        }
+
+        writePos.store (pos, std::memory_order_release);
+    }
+
+    // Advances the position without writing, so positions keep matching the analyser
+    void skip (int numSamples) noexcept
+    {
+        writing = false;
+        writePos.store (writePos.load (std::memory_order_relaxed) + numSamples, std::memory_order_release);
+    }
+
+    // --- Consumer ---
+    double getSampleRate() const noexcept { return sampleRate.load (std::memory_order_relaxed); }
+
+    // Copies the samples [start, start + numSamples). Returns false if any of them was
+    // skipped, not written yet, or overwritten while copying.
+    bool read (juce::int64 start, int numSamples, float* dest) const noexcept
+    {
+        auto isAvailable = [&]
+        {
+            const auto end = writePos.load (std::memory_order_acquire);
+            return start >= validFrom.load (std::memory_order_relaxed)
+                && start + numSamples <= end
+                && start >= end - capacity;
+        };
+
+        if (numSamples > capacity || ! isAvailable())
+            return false;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int slot = (int) ((start + done) & mask);
+            const int count = juce::jmin (numSamples - done, capacity - slot);
+            std::copy (data + slot, data + slot + count, dest + done);
+            done += count;
+        }
+
+        // The writer may have lapped us meanwhile; then the copy is torn
+        return isAvailable();
+    }
+
+private:
+    static constexpr juce::int64 mask = Capacity - 1;
+
+    float data[Capacity] {};
+
+    alignas (64) std::atomic<juce::int64> writePos { 0 };
+    std::atomic<juce::int64> validFrom { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+    bool writing = false; // audio thread only
+};
@@ -0,0 +1,174 @@
+#include "SavedHistory.h"
+#include "DeltaCodec.h"
+
+namespace
+{
+    using StateCodec = LogLevelCodec16;
+
+    // Lane samples copied per history lock
+    constexpr juce::int64 sliceFrames = 16384;
+}
+
+SavedHistory::SavedHistory (const HistoryStore& historyToUse)
+    : history (historyToUse)
+{
+}
+
+void SavedHistory::encodeLane (const float* levels, int numFrames, juce::MemoryBlock& dest)
+{
+    juce::MemoryOutputStream varints ((size_t) numFrames + 64);
+    DeltaCodec<StateCodec>::write (varints, levels, numFrames);
+
+    juce::MemoryOutputStream compressed (dest, false);
+    juce::GZIPCompressorOutputStream zip (compressed, 6);
+    zip.write (varints.getData(), varints.getDataSize());
+    zip.flush();
+}
+
+bool SavedHistory::decodeLane (const void* data, size_t size, float* levels, int numFrames)
+{
+    juce::MemoryInputStream compressed (data, size, false);
+    juce::GZIPDecompressorInputStream zip (compressed);
+
+    // Inflated in one go, then parsed from memory. A varint takes at most 5 bytes,
+    // which also bounds what a corrupt block can make us inflate.
+    juce::MemoryBlock varints;
+    zip.readIntoMemoryBlock (varints, (ssize_t) numFrames * 5);
+
+    const auto* pos = static_cast<const juce::uint8*> (varints.getData());
+    return DeltaCodec<StateCodec>::read (pos, pos + varints.getSize(), levels, numFrames);
+}
+
+SavedHistory::EncodedBlock SavedHistory::encodeBlock (juce::int64 index, juce::int64 start, juce::int64 end) const
+{
+    EncodedBlock block;
+    block.index = index;
+    block.numFrames = (int) (end - start);
+
+    std::vector<float> rms ((size_t) block.numFrames), peak ((size_t) block.numFrames);
+
+    // Short copies under the lock, so the drain thread never waits on the encoder
+    for (auto pos = start; pos < end; pos += sliceFrames)
+    {
+        const auto length = juce::jmin (sliceFrames, end - pos);
+        const auto offset = (size_t) (pos - start);
+
+        const juce::ScopedLock sl (history.getLock());
+        const auto framesAgo = history.getPyramid().getNumWritten() - (pos + length);
+
+        history.getPyramid().readRaw (framesAgo, length, rms.data() + offset);
+        history.getPeakPyramid().readRaw (framesAgo, length, peak.data() + offset);
+    }
+
+    encodeLane (rms.data(), block.numFrames, block.rms);
+    encodeLane (peak.data(), block.numFrames, block.peak);
+    return block;
+}
+
+void SavedHistory::write (juce::OutputStream& out)
+{
+    const juce::ScopedLock cl (cacheLock);
+
+    const int generation = history.getGeneration();
+    juce::int64 oldest, newest;
+
+    {
+        const juce::ScopedLock sl (history.getLock());
+        newest = history.getPyramid().getNumWritten();
+        oldest = newest - history.getPyramid().getNumAvailable();
+    }
+
+    // A restored history counts frames from 0 again, so cached blocks no longer line up
+    if (generation != cacheGeneration)
+    {
+        cache.clear();
+        cacheGeneration = generation;
+    }
+
+    // Whole blocks only, starting at the first block still completely in the ring.
+    // The ring holds far more than maxBlocks, so the oldest one kept never shifts under us.
+    const auto endBlock = newest / blockFrames; // the partial block starts here
+    const auto firstBlock = juce::jmax ((oldest + blockFrames - 1) / blockFrames, endBlock + 1 - maxBlocks);
+
+    cache.erase (std::remove_if (cache.begin(), cache.end(),
+                                 [firstBlock] (const EncodedBlock& b) { return b.index < firstBlock; }),
+                 cache.end());
+
+    for (auto index = cache.empty() ? firstBlock : cache.back().index + 1; index < endBlock; ++index)
+        cache.push_back (encodeBlock (index, index * blockFrames, (index + 1) * blockFrames));
+
+    const auto partialStart = juce::jmax (endBlock * blockFrames, oldest);
+    const bool hasPartial = partialStart < newest;
+
+    const int numBlocks = (int) cache.size() + (hasPartial ? 1 : 0);
+    out.writeInt (numBlocks);
+
+    auto writeBlock = [&out] (const EncodedBlock& b)
+    {
+        out.writeInt (b.numFrames);
+        out.writeInt ((int) b.rms.getSize());
+        out.writeInt ((int) b.peak.getSize());
+        out.write (b.rms.getData(), b.rms.getSize());
+        out.write (b.peak.getData(), b.peak.getSize());
+    };
+
+    for (const auto& b : cache)
+        writeBlock (b);
+
+    if (hasPartial)
+        writeBlock (encodeBlock (endBlock, partialStart, newest));
+}
+
+bool SavedHistory::read (juce::InputStream& in, HistoryStore& history)
+{
+    const int numBlocks = in.readInt();
+
+    if (numBlocks < 0 || numBlocks > maxBlocks + 1)
+        return false;
+
+    struct Source
+    {
+        juce::int64 offset; // into the decoded lanes
+        int numFrames;
+        juce::MemoryBlock rms, peak;
+    };
+
+    std::vector<Source> sources ((size_t) numBlocks);
+    juce::int64 numFrames = 0;
+
+    for (auto& s : sources)
+    {
+        s.offset = numFrames;
+        s.numFrames = in.readInt();
+        const int rmsBytes = in.readInt();
+        const int peakBytes = in.readInt();
+
+        if (s.numFrames < 0 || s.numFrames > blockFrames || rmsBytes < 0 || peakBytes < 0
+             || (juce::int64) rmsBytes + peakBytes > in.getNumBytesRemaining())
+            return false;
+
+        in.readIntoMemoryBlock (s.rms, rmsBytes);
+        in.readIntoMemoryBlock (s.peak, peakBytes);
+        numFrames += s.numFrames;
+    }
+
+    std::vector<float> rms ((size_t) numFrames), peak ((size_t) numFrames);
+    std::atomic<bool> ok { true };
+
+    juce::SharedResourcePointer<RenderWorkerPool> pool;
+    pool->parallelFor (numBlocks * 2, [&] (int task)
+    {
+        const auto& s = sources[(size_t) (task / 2)];
+        const auto& data = (task % 2 == 0) ? s.rms : s.peak;
+        auto* dest = ((task % 2 == 0) ? rms.data() : peak.data()) + s.offset;
+
+        if (! decodeLane (data.getData(), data.getSize(), dest, s.numFrames))
+            ok = false;
+    });
+
+    if (! ok)
+        return false;
+
+    history.restore (rms.data(), peak.data(), numFrames);
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+
+// The recent RAM history in the compact form stored with the plugin state.
+//
+// Levels are quantised to 16-bit log codes (LogLevelCodec16), delta-coded frame
+// to frame as zig-zag varints and deflated, per lane and per block of blockFrames
+// frames that start on a block-aligned absolute frame. Steady or quiet material
+// shrinks to a few bytes per block, noise to well under 2 bytes per frame and lane.
+//
+// Saving is incremental: the ring only ever appends, so a completed block never
+// changes and its encoding is cached; each save only encodes the newest, partial
+// block. Blocks decode independently, so restoring spreads them over the shared
+// RenderWorkerPool before rebuilding the pyramids with HistoryStore::restore().
+//
+// Layout (all integers little endian):
+//   int32 numBlocks
+//   numBlocks x { int32 numFrames, int32 rmsBytes, int32 peakBytes, rms data, peak data }
+class SavedHistory
+{
+public:
+    explicit SavedHistory (const HistoryStore& historyToUse);
+
+    // 4 blocks of 64K frames ~ 44 minutes at the 10 ms hop
+    static constexpr int blockFrames = 65536;
+    static constexpr int maxBlocks = 4;
+
+    // Appends the newest (at most maxBlocks) blocks of history. Safe on any thread.
+    void write (juce::OutputStream& out);
+
+    // Reads what write() produced and restores it into history. Returns false,
+    // leaving history untouched, if the data is truncated or corrupt.
+    static bool read (juce::InputStream& in, HistoryStore& history);
+
+private:
+    struct EncodedBlock
+    {
+        juce::int64 index = 0; // absolute frame / blockFrames
+        int numFrames = 0;
+        juce::MemoryBlock rms, peak;
+    };
+
+    EncodedBlock encodeBlock (juce::int64 index, juce::int64 start, juce::int64 end) const;
+
+    static void encodeLane (const float* levels, int numFrames, juce::MemoryBlock& dest);
+    static bool decodeLane (const void* data, size_t size, float* levels, int numFrames);
+
+    const HistoryStore& history;
+
+    juce::CriticalSection cacheLock;
+    std::vector<EncodedBlock> cache; // completed blocks, oldest first
+    int cacheGeneration = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SavedHistory)
+};
@@ -0,0 +1,89 @@
+#include "ScopeStats.h"
+
+void TimingHistogram::record (double microseconds) noexcept
+{
+    const auto n = count.load (std::memory_order_relaxed);
+
+    if (n == 0 || microseconds < minUs.load (std::memory_order_relaxed)) minUs.store (microseconds, std::memory_order_relaxed);
+    if (n == 0 || microseconds > maxUs.load (std::memory_order_relaxed)) maxUs.store (microseconds, std::memory_order_relaxed);
+
+    const auto octaves = std::log2 (juce::jmax (microseconds, 1.0e-3));
+    const auto bucket = juce::jlimit (0, numBuckets - 1, (int) std::floor (octaves * bucketsPerOctave) + bucketOffset);
+
+    addRelaxed (buckets[bucket], (juce::int64) 1);
+    addRelaxed (sumUs, microseconds);
+    count.store (n + 1, std::memory_order_release);
+}
+
+TimingHistogram::Summary TimingHistogram::getSummary() const noexcept
+{
+    Summary s;
+    s.count = count.load (std::memory_order_acquire);
+
+    if (s.count == 0)
+        return s;
+
+    s.minUs = minUs.load (std::memory_order_relaxed);
+    s.maxUs = maxUs.load (std::memory_order_relaxed);
+    s.meanUs = sumUs.load (std::memory_order_relaxed) / (double) s.count;
+
+    // Upper edge of the bucket that holds the 99th percentile
+    const auto target = (juce::int64) std::ceil ((double) s.count * 0.99);
+    juce::int64 seen = 0;
+
+    for (int b = 0; b < numBuckets; ++b)
+    {
+        seen += buckets[b].load (std::memory_order_relaxed);
+
+        if (seen >= target)
+        {
+            s.p99Us = juce::jmin (getBucketUpperBound (b), s.maxUs);
+            break;
+        }
+    }
+
+    return s;
+}
+
+void ScopeStats::recordDrain (int numFrames) noexcept
+{
+    addRelaxed (drainTicks, (juce::int64) 1);
+    addRelaxed (framesDrained, (juce::int64) numFrames);
+    lastDrained.store (numFrames, std::memory_order_relaxed);
+
+    if (numFrames > maxDrained.load (std::memory_order_relaxed))
+        maxDrained.store (numFrames, std::memory_order_relaxed);
+}
+
+const char* ScopeStats::getZoneName (int zone) noexcept
+{
+    switch (zone)
+    {
+        case rawZone:      return "Raw";
+        case midZone:      return "Mid";
+        case overviewZone: return "Overview";
+        case laneZone:     return "Lanes";
+        case gpuZone:      return "GPU overlay";
+        default:           return "";
+    }
+}
+
+ScopeStats::Snapshot ScopeStats::getSnapshot() const noexcept
+{
+    Snapshot s;
+    s.processBlock = processBlockTime.getSummary();
+    s.framesPushed = framesPushed.load (std::memory_order_relaxed);
+    s.framesDropped = framesDropped.load (std::memory_order_relaxed);
+
+    s.drainTicks = drainTicks.load (std::memory_order_relaxed);
+    s.lastDrained = lastDrained.load (std::memory_order_relaxed);
+    s.maxDrained = maxDrained.load (std::memory_order_relaxed);
+    s.meanDrained = s.drainTicks > 0 ? (double) framesDrained.load (std::memory_order_relaxed) / (double) s.drainTicks : 0.0;
+
+    for (int z = 0; z < numZones; ++z)
+        s.paint[z] = paintTime[z].getSummary();
+
+    s.pointsPerFrame = pointsPerFrame.load (std::memory_order_relaxed);
+    s.allocationsPerFrame = allocationsPerFrame.load (std::memory_order_relaxed);
+    return s;
+}
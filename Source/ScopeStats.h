@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Adds to a counter that only one thread writes. A plain load + store is enough
+// there, and much cheaper than fetch_add on the audio thread.
+template <typename T>
+inline void addRelaxed (std::atomic<T>& value, T delta) noexcept
+{
+    value.store (value.load (std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// Log-spaced latency histogram with a single writer and any number of readers.
+//
+// record() only does relaxed loads and stores (no read-modify-write), so it is
+// cheap enough for the audio thread. Readers get a consistent-enough summary:
+// a value recorded during getSummary() may or may not be included.
+class TimingHistogram
+{
+public:
+    struct Summary
+    {
+        juce::int64 count = 0;
+        double minUs = 0.0, meanUs = 0.0, p99Us = 0.0, maxUs = 0.0;
+    };
+
+    void record (double microseconds) noexcept;
+    Summary getSummary() const noexcept;
+
+private:
+    // Four buckets per octave from 0.25 us up to ~260 ms; slower values land in the last one.
+    static constexpr int bucketsPerOctave = 4;
+    static constexpr int bucketOffset = 8; // bucket 0 starts at 2^-2 us
+    static constexpr int numBuckets = 80;
+
+    static double getBucketUpperBound (int bucket) noexcept
+    {
+        return std::exp2 ((double) (bucket - bucketOffset + 1) / (double) bucketsPerOctave);
+    }
+
+    std::atomic<juce::int64> buckets[numBuckets] {};
+    std::atomic<juce::int64> count { 0 };
+    std::atomic<double> sumUs { 0.0 }, minUs { 0.0 }, maxUs { 0.0 };
+};
+
+// Hot-path counters for the diagnostics overlay (toggle with 'D' in the editor).
+//
+// Owned by the processor so they cover the audio thread and the history thread
+// whether or not an editor is open. Every field has exactly one writing thread
+// and is updated with relaxed atomics; getSnapshot() can be called from anywhere.
+class ScopeStats
+{
+public:
+    // --- Audio thread ---
+    TimingHistogram processBlockTime;
+    std::atomic<juce::int64> framesPushed { 0 };
+    std::atomic<juce::int64> framesDropped { 0 }; // pushToFifo() found the ring full
+
+    // --- History thread ---
+    void recordDrain (int numFrames) noexcept;
+
+    // --- Message thread (editor) ---
+    enum Zone { rawZone = 0, midZone, overviewZone, laneZone, gpuZone, numZones };
+
+    static const char* getZoneName (int zone) noexcept;
+
+    TimingHistogram paintTime[numZones];
+    std::atomic<int> pointsPerFrame { 0 };
+    std::atomic<juce::int64> allocationsPerFrame { 0 };
+
+    struct Snapshot
+    {
+        TimingHistogram::Summary processBlock;
+        juce::int64 framesPushed = 0, framesDropped = 0;
+        int fifoFill = 0, fifoCapacity = 0; // live values, see SmoothScopeAudioProcessor::getStatsSnapshot()
+
+        juce::int64 drainTicks = 0;
+        int lastDrained = 0, maxDrained = 0;
+        double meanDrained = 0.0;
+
+        TimingHistogram::Summary paint[numZones];
+        int pointsPerFrame = 0;
+        juce::int64 allocationsPerFrame = 0;
+    };
+
+    // fifoFill and fifoCapacity are left empty; the processor, which owns the FIFO, fills them in.
+    Snapshot getSnapshot() const noexcept;
+
+private:
+    std::atomic<juce::int64> drainTicks { 0 }, framesDrained { 0 };
+    std::atomic<int> lastDrained { 0 }, maxDrained { 0 };
+};
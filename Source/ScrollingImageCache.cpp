@@ -0,0 +1,133 @@
+#include "ScrollingImageCache.h"
+
+int ScrollingImageCache::draw (juce::Graphics& g, const HistoryStore& history,
+                                int newWidth, int newHeight, float newZoomX, float newZoomY, const LodPlan& plan,
+                                juce::int64 endFrame)
+{
+    if (newWidth <= 0 || newHeight <= 0 || endFrame <= 0)
+        return 0;
+
+    const float newScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    // Anything that changes the pixels of already-rendered columns needs a full re-render
+    if (newWidth != width || newHeight != height || newScale != scale
+         || newZoomX != zoomX || newZoomY != zoomY || plan.detail != detail)
+    {
+        width = newWidth;
+        height = newHeight;
+        scale = newScale;
+        zoomX = newZoomX;
+        zoomY = newZoomY;
+        detail = plan.detail;
+
+        image = juce::Image (juce::Image::RGB, width, juce::jmax (1, juce::roundToInt ((float) height * scale)), true);
+        headColumn = -1;
+    }
+
+    // Column k holds the samples s with floor (s * zoomX) == k
+    const juce::int64 newHead = (juce::int64) std::floor ((double) (endFrame - 1) * (double) zoomX);
+
+    int numPoints;
+
+    if (headColumn < 0 || std::abs (newHead - headColumn) >= width)
+        numPoints = renderColumns (newHead - width + 1, newHead, history);
+    else if (newHead >= headColumn)
+        numPoints = renderColumns (headColumn, newHead, history); // the old head column was still partial
+    else
+        numPoints = renderColumns (newHead - width + 1, headColumn - width, history); // panned back: the columns now on the left
+
+    headColumn = newHead;
+
+    // Blit the ring: the slot of the head column lands on the right edge.
+    const int headSlot = (int) (headColumn % width);
+    const int imageH = image.getHeight();
+    const int rightPart = headSlot + 1;      // slots [0, headSlot]
+    const int leftPart = width - rightPart;  // slots [headSlot + 1, width)
+
+    g.setImageResamplingQuality (juce::Graphics::lowResamplingQuality);
+    g.drawImage (image, width - rightPart, 0, rightPart, height, 0, 0, rightPart, imageH);
+
+    if (leftPart > 0)
+        g.drawImage (image, 0, 0, leftPart, height, rightPart, 0, leftPart, imageH);
+
+    return numPoints;
+}
+
+int ScrollingImageCache::renderColumns (juce::int64 firstColumn, juce::int64 lastColumn, const HistoryStore& history)
+{
+    // Pixels are written directly rather than through a Graphics context, which
+    // would allocate a renderer (and edge tables) on every incremental update.
+    juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readWrite);
+
+    const float imageH = (float) image.getHeight();
+    const ScopeMapping mapping { imageH, zoomY };
+    const LodPlan style { false, 0, 0, 0, 0, detail };
+    const float minThickness = style.getMinThickness() * scale;
+
+    const auto background = juce::Colours::black;
+    const auto midLine = juce::Colours::darkgrey.withAlpha (0.5f);
+    const auto fill = juce::Colours::cyan.withAlpha (style.getFillAlpha());
+    const auto edge = juce::Colours::cyan;
+    const auto peakColour = juce::Colours::cyan.withAlpha (0.35f);
+
+    // Blends colour over [top, bottom) of one column, with fractional coverage at both ends
+    auto fillSpan = [&] (int x, float top, float bottom, juce::Colour colour)
+    {
+        top = juce::jlimit (0.0f, imageH, top);
+        bottom = juce::jlimit (0.0f, imageH, bottom);
+
+        for (int y = (int) top; (float) y < bottom; ++y)
+        {
+            const float coverage = juce::jmin ((float) (y + 1), bottom) - juce::jmax ((float) y, top);
+
+            if (coverage > 0.0f)
+                pixels.setPixelColour (x, y, pixels.getPixelColour (x, y).overlaidWith (colour.withMultipliedAlpha (coverage)));
+        }
+    };
+
+    const double samplesPerPixel = 1.0 / (double) zoomX;
+    int numPoints = 0;
+
+    for (juce::int64 column = firstColumn; column <= lastColumn; ++column)
+    {
+        // Columns before the start of the history still get cleared to the background
+        const int slot = (int) (((column % width) + width) % width);
+
+        fillSpan (slot, 0.0f, imageH, background);
+        fillSpan (slot, std::floor (imageH * 0.5f), std::floor (imageH * 0.5f) + scale, midLine);
+
+        const auto start = (juce::int64) std::ceil ((double) column * samplesPerPixel);
+        const auto end   = juce::jmax (start + 1, (juce::int64) std::ceil ((double) (column + 1) * samplesPerPixel));
+
+        auto getRange = [&] (int lane, MinMax& result)
+        {
+            return diskSummariesOnly ? history.getOverviewRangeAbsolute (lane, start, end, result)
+                                     : history.getRangeAbsolute (lane, start, end, result);
+        };
+
+        MinMax range, peakRange;
+        if (! getRange (HistoryStore::rmsLane, range))
+            continue;
+
+        float yMax = mapping.toY (range.max);
+        float yMin = mapping.toY (range.min);
+        ScopeMapping::enforceThickness (yMax, yMin, minThickness);
+
+        if (getRange (HistoryStore::peakLane, peakRange))
+        {
+            const float yPeak = mapping.toY (peakRange.max);
+            fillSpan (slot, yPeak - scale * 0.5f, yPeak + scale * 0.5f, peakColour);
+        }
+
+        fillSpan (slot, yMax, yMin, fill);
+
+        // Lighter edges for definition
+        fillSpan (slot, yMax - scale * 0.5f, yMax + scale * 0.5f, edge);
+        fillSpan (slot, yMin - scale * 0.5f, yMin + scale * 0.5f, edge);
+
+        // Roof, floor and peak, counted like ColumnEnvelope::paint()
+        numPoints += 3;
+    }
+
+    return numPoints;
+}
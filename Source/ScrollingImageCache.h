@@ -0,0 +1,45 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "HistoryStore.h"
+#include "ColumnEnvelope.h"
+#include "LodPlanner.h"
+
+// Cached-image scrolling renderer for the envelope zones (ZoomX < 1.0).
+//
+// Columns are anchored to absolute sample positions rather than to the write
+// head, so once a column is complete its pixels never change. The rendered
+// envelope is kept in an offscreen image used as a ring of columns: when new
+// frames arrive only the columns they touched are rasterised, and the ring is
+// blitted in (at most) two pieces. A full re-render only happens when the
+// zoom, size or display scale changes - per frame cost is O(new data).
+// Panning works the same way in either direction: only the columns scrolled
+// into view are rasterised.
+class ScrollingImageCache
+{
+public:
+    // endFrame is the absolute frame just past the right edge: the write head,
+    // or an older position while the view is paused. Must be called with the history lock held.
+    // Returns the number of envelope points rasterised, i.e. only those of the new columns.
+    int draw (juce::Graphics& g, const HistoryStore& history,
+               int width, int height, float zoomX, float zoomY, const LodPlan& plan, juce::int64 endFrame);
+
+    void invalidate() noexcept { headColumn = -1; }
+
+    // Reads history older than the RAM ring from the disk's chunk summaries alone
+    // (HistoryStore::getOverviewRangeAbsolute()), so rendering never maps chunk files.
+    // For overviews where a column spans minutes anyway.
+    void setDiskSummariesOnly (bool shouldUseSummaries) noexcept { diskSummariesOnly = shouldUseSummaries; invalidate(); }
+
+private:
+    int renderColumns (juce::int64 firstColumn, juce::int64 lastColumn, const HistoryStore& history);
+
+    juce::Image image;   // one pixel per logical column, physical resolution vertically
+
+    int width = 0, height = 0;
+    float scale = 1.0f, zoomX = 0.0f, zoomY = 0.0f;
+    float detail = -1.0f;
+    bool diskSummariesOnly = false;
+
+    juce::int64 headColumn = -1; // absolute index of the column at the right edge (possibly partial)
+};
@@ -0,0 +1,65 @@
+#include "SpectralAnalyser.h"
+#include "LevelKernel.h"
+
+SpectralWindow::SpectralWindow()
+    : window ((size_t) fftSize)
+{
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) fftSize,
+                                                              juce::dsp::WindowingFunction<float>::hann, false);
+
+    // One-sided power of a windowed sine of RMS r is r^2 * N * sum (w^2) / 2
+    double windowPower = 0.0;
+    for (auto w : window)
+        windowPower += (double) w * (double) w;
+
+    energyToLevel = (float) (2.0 / ((double) fftSize * windowPower));
+}
+
+float SpectralAnalyser::getBandEdgeFrequency (int band) noexcept
+{
+    return minFrequency * std::pow (maxFrequency / minFrequency, (float) band / (float) numBands);
+}
+
+void SpectralAnalyser::updateLayout (double sampleRate)
+{
+    layoutSampleRate = sampleRate;
+
+    const double binWidth = sampleRate / (double) SpectralWindow::fftSize;
+    constexpr int lastBin = SpectralWindow::fftSize / 2;
+
+    // Every band gets at least one bin; at the bottom that is all the resolution there is
+    for (int b = 0; b <= numBands; ++b)
+    {
+        const int bin = juce::roundToInt ((double) getBandEdgeFrequency (b) / binWidth);
+        bandEdges[b] = juce::jlimit (1, lastBin, b == 0 ? bin : juce::jmax (bin, bandEdges[b - 1] + 1));
+    }
+}
+
+void SpectralAnalyser::analyse (const Tap& tap, juce::int64 endSample, float* bandLevels)
+{
+    if (tap.getSampleRate() != layoutSampleRate)
+        updateLayout (tap.getSampleRate());
+
+    if (! tap.read (endSample - SpectralWindow::fftSize, SpectralWindow::fftSize, samples.data()))
+    {
+        std::fill (bandLevels, bandLevels + numBands, 0.0f);
+        return;
+    }
+
+    constexpr int fftSize = SpectralWindow::fftSize;
+
+    juce::FloatVectorOperations::multiply (scratch.data(), samples.data(), window->getWindow(), fftSize);
+    juce::FloatVectorOperations::clear (scratch.data() + fftSize, fftSize);
+
+    // Magnitudes of bins 0 .. fftSize / 2 end up in the first half
+    fft.performFrequencyOnlyForwardTransform (scratch.data(), true);
+
+    // Band energy is the sum of squared magnitudes, i.e. the fused SIMD level
+    // kernel's sum-of-squares over the band's bins.
+    for (int b = 0; b < numBands; ++b)
+    {
+        BlockMeasurement m;
+        LevelKernel::measure (scratch.data() + bandEdges[b], bandEdges[b + 1] - bandEdges[b], m);
+        bandLevels[b] = (float) std::sqrt (m.sumSquares * (double) window->getEnergyToLevel());
+    }
+}
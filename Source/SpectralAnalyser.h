@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleTap.h"
+
+// The Hann window and its level scale, shared by every plugin instance in the
+// process through juce::SharedResourcePointer. Both are filled in once by the
+// constructor and only read afterwards, so instances need no lock to use them.
+class SpectralWindow
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+
+    SpectralWindow();
+
+    const float* getWindow() const noexcept { return window.data(); }
+
+    // Scales the summed squared magnitudes of a windowed band to an RMS-equivalent level
+    float getEnergyToLevel() const noexcept { return energyToLevel; }
+
+private:
+    std::vector<float> window;
+    float energyToLevel = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectralWindow)
+};
+
+// Per-instance band analysis for the history thread.
+//
+// Every level frame gets one band frame, computed from the fftSize samples that
+// end where the frame's hop ends (LevelFrame::endSample). Consecutive windows
+// overlap by fftSize - hopSize, and the band lanes line up frame for frame with
+// the RMS history. Each analyser has its own FFT and scratch, so instances
+// never wait on one another; the history thread runs it without the history lock.
+class SpectralAnalyser
+{
+public:
+    // 32 log-spaced bands, ~1/3 octave, from 20 Hz to 20 kHz (or Nyquist)
+    static constexpr int numBands = 32;
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+
+    // ~1.4 s at 48 kHz; the history thread drains every 10 ms
+    using Tap = SampleTap<65536>;
+
+    // Band levels of the window ending at endSample; silence if the tap does not hold it.
+    // Hann-windowed power spectrum summed over each band's bins: a sine of RMS r whose
+    // energy falls in one band reads r in that band.
+    void analyse (const Tap& tap, juce::int64 endSample, float* bandLevels);
+
+    // Lower edge of band b (b = numBands gives the top edge), in Hz
+    static float getBandEdgeFrequency (int band) noexcept;
+
+private:
+    void updateLayout (double sampleRate);
+
+    juce::SharedResourcePointer<SpectralWindow> window;
+    juce::dsp::FFT fft { SpectralWindow::fftOrder };
+
+    double layoutSampleRate = 0.0;
+    int bandEdges[numBands + 1] {};
+    std::vector<float> samples = std::vector<float> ((size_t) SpectralWindow::fftSize);
+    std::vector<float> scratch = std::vector<float> ((size_t) SpectralWindow::fftSize * 2);
+};
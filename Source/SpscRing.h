@@ -0,0 +1,115 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lock-free single-producer / single-consumer ring.
+//
+// - Capacity is a power of two; indices run freely and are masked on access,
+//   so all slots are usable and there is no modulo anywhere.
+// - The producer and consumer indices live on separate cache lines, away from
+//   the data, so the two threads do not false-share.
+// - Each side caches the other side's index and only reloads it (one acquire)
+//   when the cached value says there is not enough space / data.
+// - prepareWrite / prepareRead hand out up to two contiguous spans (the second
+//   one is non-empty only at the wrap point); commitWrite / commitRead publish
+//   them with a single release store.
+template <typename T, int Capacity>
+class SpscRing
+{
+public:
+    static_assert (Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static constexpr int capacity = Capacity;
+
+    template <typename ElementType>
+    struct Spans
+    {
+        ElementType* data1 = nullptr;
+        int size1 = 0;
+        ElementType* data2 = nullptr;
+        int size2 = 0;
+
+        int getTotalSize() const noexcept { return size1 + size2; }
+
+        template <typename Fn>
+        void forEach (Fn&& fn) const
+        {
+            for (int i = 0; i < size1; ++i) fn (data1[i]);
+            for (int i = 0; i < size2; ++i) fn (data2[i]);
+        }
+    };
+
+    // --- Producer side ---
+    Spans<T> prepareWrite (int maxItems) noexcept
+    {
+        const auto write = writeIndex.load (std::memory_order_relaxed);
+
+        if (Capacity - (int) (write - cachedReadIndex) < maxItems)
+            cachedReadIndex = readIndex.load (std::memory_order_acquire);
+
+        const int numItems = juce::jmin (maxItems, Capacity - (int) (write - cachedReadIndex));
+        return makeSpans<T> (write, numItems);
+    }
+
+    void commitWrite (int numItems) noexcept
+    {
+        writeIndex.store (writeIndex.load (std::memory_order_relaxed) + (juce::uint32) numItems, std::memory_order_release);
+    }
+
+    // Returns false (and drops the item) if the ring is full.
+    bool push (const T& item) noexcept
+    {
+        auto spans = prepareWrite (1);
+
+        if (spans.size1 == 0)
+            return false;
+
+        spans.data1[0] = item;
+        commitWrite (1);
+        return true;
+    }
+
+    // --- Consumer side ---
+    Spans<const T> prepareRead (int maxItems = Capacity) noexcept
+    {
+        const auto read = readIndex.load (std::memory_order_relaxed);
+
+        if ((int) (cachedWriteIndex - read) < maxItems)
+            cachedWriteIndex = writeIndex.load (std::memory_order_acquire);
+
+        const int numItems = juce::jmin (maxItems, (int) (cachedWriteIndex - read));
+        return makeSpans<const T> (read, numItems);
+    }
+
+    void commitRead (int numItems) noexcept
+    {
+        readIndex.store (readIndex.load (std::memory_order_relaxed) + (juce::uint32) numItems, std::memory_order_release);
+    }
+
+    // Approximate fill level, safe to call from any thread.
+    int getNumReady() const noexcept
+    {
+        return (int) (writeIndex.load (std::memory_order_acquire) - readIndex.load (std::memory_order_acquire));
+    }
+
+private:
+    template <typename ElementType>
+    Spans<ElementType> makeSpans (juce::uint32 start, int numItems) noexcept
+    {
+        const int first = (int) (start & (juce::uint32) (Capacity - 1));
+        const int size1 = juce::jmin (numItems, Capacity - first);
+
+        return { buffer + first, size1, buffer, numItems - size1 };
+    }
+
+    static constexpr size_t cacheLineSize = 64;
+
+    // Producer-owned
+    alignas (cacheLineSize) std::atomic<juce::uint32> writeIndex { 0 };
+    juce::uint32 cachedReadIndex = 0;
+
+    // Consumer-owned
+    alignas (cacheLineSize) std::atomic<juce::uint32> readIndex { 0 };
+    juce::uint32 cachedWriteIndex = 0;
+
+    alignas (cacheLineSize) T buffer[Capacity] {};
+};
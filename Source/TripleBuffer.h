@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lock-free hand-over of the newest value from one producer thread to one consumer.
+//
+// The producer always owns a back slot and the consumer a front slot, so neither
+// ever waits for the other. publish() swaps the back slot with the shared middle
+// one; acquire() swaps the middle slot into the front if something new was
+// published since the last call. Intermediate values the consumer never picked up
+// are simply overwritten, which is exactly what a renderer wants.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // --- Producer ---
+    T& getWriteBuffer() noexcept { return slots[back]; }
+
+    void publish() noexcept
+    {
+        back = middle.exchange (back | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // --- Consumer ---
+    bool hasNewData() const noexcept { return (middle.load (std::memory_order_acquire) & dirtyBit) != 0; }
+
+    // Swaps in the newest published value; returns false if there was nothing new.
+    bool acquire() noexcept
+    {
+        if (! hasNewData())
+            return false;
+
+        front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return slots[front]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int dirtyBit = 4;
+
+    T slots[3];
+    int back = 0;                  // producer only
+    int front = 1;                 // consumer only
+    std::atomic<int> middle { 2 }; // slot index, plus dirtyBit while unread
+};
@@ -0,0 +1,149 @@
+#include "TruePeakDetector.h"
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SMOOTHSCOPE_TRUEPEAK_NEON 1
+#elif defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64)
+ #include <immintrin.h>
+ #define SMOOTHSCOPE_TRUEPEAK_SSE 1
+#endif
+
+namespace
+{
+    // BS.1770-4 Annex 2 interpolation filter, transposed to [tap][phase] so one
+    // row is the vector of all four phases' coefficients for that tap.
+    alignas (16) constexpr float coefficients[TruePeakDetector::tapsPerPhase][TruePeakDetector::oversampling]
+    {
+        {  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+        {  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+        { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+        {  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+        { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+        {  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+        {  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+        { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+        {  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+        { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+        {  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+        { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f },
+    };
+
+    constexpr int numTaps = TruePeakDetector::tapsPerPhase;
+
+    // x points at the newest of numTaps samples; x[-k] is the sample k steps back.
+    // Returns max |y| over the outputs of samples [first, end) of x.
+    [[maybe_unused]] float filterScalar (const float* x, int first, int end, float peak) noexcept
+    {
+        for (int n = first; n < end; ++n)
+        {
+            for (int phase = 0; phase < TruePeakDetector::oversampling; ++phase)
+            {
+                float y = 0.0f;
+
+                for (int k = 0; k < numTaps; ++k)
+                    y += coefficients[k][phase] * x[n - k];
+
+                peak = juce::jmax (peak, std::abs (y));
+            }
+        }
+
+        return peak;
+    }
+
+   #if SMOOTHSCOPE_TRUEPEAK_SSE
+
+    float filterSSE (const float* x, int first, int end, float peak) noexcept
+    {
+        __m128 c[numTaps];
+        for (int k = 0; k < numTaps; ++k)
+            c[k] = _mm_load_ps (coefficients[k]);
+
+        const __m128 absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+        __m128 mx = _mm_set1_ps (peak);
+
+        for (int n = first; n < end; ++n)
+        {
+            // Two accumulators halve the dependency chain
+            __m128 y0 = _mm_mul_ps (c[0], _mm_set1_ps (x[n]));
+            __m128 y1 = _mm_mul_ps (c[1], _mm_set1_ps (x[n - 1]));
+
+            for (int k = 2; k < numTaps; k += 2)
+            {
+                y0 = _mm_add_ps (y0, _mm_mul_ps (c[k],     _mm_set1_ps (x[n - k])));
+                y1 = _mm_add_ps (y1, _mm_mul_ps (c[k + 1], _mm_set1_ps (x[n - k - 1])));
+            }
+
+            mx = _mm_max_ps (mx, _mm_and_ps (_mm_add_ps (y0, y1), absMask));
+        }
+
+        mx = _mm_max_ps (mx, _mm_movehl_ps (mx, mx));
+        mx = _mm_max_ss (mx, _mm_shuffle_ps (mx, mx, 1));
+        return _mm_cvtss_f32 (mx);
+    }
+
+   #endif
+
+   #if SMOOTHSCOPE_TRUEPEAK_NEON
+
+    float filterNeon (const float* x, int first, int end, float peak) noexcept
+    {
+        float32x4_t c[numTaps];
+        for (int k = 0; k < numTaps; ++k)
+            c[k] = vld1q_f32 (coefficients[k]);
+
+        float32x4_t mx = vdupq_n_f32 (peak);
+
+        for (int n = first; n < end; ++n)
+        {
+            float32x4_t y0 = vmulq_n_f32 (c[0], x[n]);
+            float32x4_t y1 = vmulq_n_f32 (c[1], x[n - 1]);
+
+            for (int k = 2; k < numTaps; k += 2)
+            {
+                y0 = vmlaq_n_f32 (y0, c[k],     x[n - k]);
+                y1 = vmlaq_n_f32 (y1, c[k + 1], x[n - k - 1]);
+            }
+
+            mx = vmaxq_f32 (mx, vabsq_f32 (vaddq_f32 (y0, y1)));
+        }
+
+        float lanes[4];
+        vst1q_f32 (lanes, mx);
+        return juce::jmax (juce::jmax (lanes[0], lanes[1]), juce::jmax (lanes[2], lanes[3]));
+    }
+
+   #endif
+
+    float filter (const float* x, int first, int end, float peak) noexcept
+    {
+       #if SMOOTHSCOPE_TRUEPEAK_NEON
+        return filterNeon (x, first, end, peak);
+       #elif SMOOTHSCOPE_TRUEPEAK_SSE
+        return filterSSE (x, first, end, peak);
+       #else
+        return filterScalar (x, first, end, peak);
+       #endif
+    }
+}
+
+void TruePeakDetector::reset() noexcept
+{
+    std::fill (std::begin (staging), std::end (staging), 0.0f);
+    peak = 0.0f;
+}
+
+void TruePeakDetector::process (const float* data, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const int chunk = juce::jmin (numSamples, stagingSize);
+
+        // staging = [last historySize samples | chunk]
+        std::copy (data, data + chunk, staging + historySize);
+        peak = filter (staging, historySize, historySize + chunk, peak);
+        std::copy (staging + chunk, staging + chunk + historySize, staging);
+
+        data += chunk;
+        numSamples -= chunk;
+    }
+}
@@ -0,0 +1,297 @@
+// SmoothScopeViewer: one window for the level broadcasts of many SmoothScope
+// instances, on this machine or elsewhere on the network.
+//
+// Build with -DSMOOTHSCOPE_BUILD_VIEWER=ON and run
+//   SmoothScopeViewer [--port number]
+//
+// Every instance with broadcasting switched on ('N' in its editor) sends its mix
+// levels to LevelBroadcast::multicastGroup. The viewer joins the group, keeps one
+// MinMaxPyramid pair per stream and draws each one with the plugin's
+// ColumnEnvelope, so the in-DAW editors can stay closed. Mouse wheel zooms time,
+// Shift + wheel zooms level.
+
+#include <JuceHeader.h>
+
+#include "LevelBroadcast.h"
+#include "MinMaxPyramid.h"
+#include "ColumnEnvelope.h"
+
+namespace
+{
+    using StreamPyramid = MinMaxPyramid<LevelBroadcast::Codec>;
+
+    // ~44 minutes per stream at the 10 ms hop, ~1.4 MB for both lanes
+    constexpr int streamCapacity = 1 << 18;
+
+    // A stream that has been quiet this long is drawn as offline
+    constexpr juce::uint32 offlineAfterMs = 2000;
+}
+
+// --- Receiver ---
+// Joins the multicast group on a background thread and files every packet
+// under its stream. Lost packets leave silence behind, late ones are dropped.
+class StreamReceiver : private juce::Thread
+{
+public:
+    struct Stream
+    {
+        juce::uint32 id = 0;
+        juce::String name;
+        float frameRate = 0.0f;
+        juce::int64 nextFrame = 0; // frame number the pyramids continue with
+        juce::uint32 lastPacketMs = 0;
+
+        StreamPyramid rms { streamCapacity }, peak { streamCapacity };
+    };
+
+    explicit StreamReceiver (int portToUse)
+        : juce::Thread ("SmoothScopeViewer Receiver"), port (portToUse)
+    {
+        startThread (juce::Thread::Priority::normal);
+    }
+
+    ~StreamReceiver() override
+    {
+        stopThread (1000);
+    }
+
+    // Must be held while reading getStreams() and their pyramids.
+    const juce::CriticalSection& getLock() const noexcept { return lock; }
+    const std::vector<std::unique_ptr<Stream>>& getStreams() const noexcept { return streams; }
+
+    // Cheap "has anything arrived?" check for the UI
+    int getNumPackets() const noexcept { return numPackets.load (std::memory_order_acquire); }
+
+    bool isListening() const noexcept { return listening.load (std::memory_order_relaxed); }
+    int getPort() const noexcept { return port; }
+
+private:
+    void run() override
+    {
+        juce::DatagramSocket socket;
+        socket.setEnablePortReuse (true); // several viewers on one machine
+
+        if (! socket.bindToPort (port) || ! socket.joinMulticast (LevelBroadcast::multicastGroup))
+            return;
+
+        listening = true;
+
+        std::vector<char> buffer (65536);
+        LevelBroadcast::Packet packet;
+
+        while (! threadShouldExit())
+        {
+            if (socket.waitUntilReady (true, 100) != 1)
+                continue;
+
+            const int size = socket.read (buffer.data(), (int) buffer.size(), false);
+
+            if (size > 0 && LevelBroadcast::read (buffer.data(), (size_t) size, packet))
+                addPacket (packet);
+        }
+
+        socket.leaveMulticast (LevelBroadcast::multicastGroup);
+    }
+
+    void addPacket (const LevelBroadcast::Packet& packet)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            auto& stream = findOrAddStream (packet);
+
+            stream.name = packet.name;
+            stream.frameRate = packet.frameRate;
+            stream.lastPacketMs = juce::Time::getMillisecondCounter();
+
+            const auto gap = packet.firstFrame - stream.nextFrame;
+
+            // A lost packet: keep the timeline in step with the sender
+            for (auto i = juce::jmin (gap, (juce::int64) streamCapacity); i > 0; --i)
+            {
+                stream.rms.push (0.0f);
+                stream.peak.push (0.0f);
+            }
+
+            // Frames that already arrived (or were given up on) are skipped
+            for (int i = (int) juce::jmax ((juce::int64) 0, -gap); i < packet.numFrames; ++i)
+            {
+                stream.rms.push (packet.rms[i]);
+                stream.peak.push (packet.peak[i]);
+            }
+
+            stream.nextFrame = juce::jmax (stream.nextFrame, packet.firstFrame + packet.numFrames);
+        }
+
+        numPackets.fetch_add (1, std::memory_order_release);
+    }
+
+    Stream& findOrAddStream (const LevelBroadcast::Packet& packet)
+    {
+        for (auto& stream : streams)
+            if (stream->id == packet.streamId)
+                return *stream;
+
+        // A new stream starts where it is, not at the sender's frame 0
+        auto stream = std::make_unique<Stream>();
+        stream->id = packet.streamId;
+        stream->nextFrame = packet.firstFrame;
+
+        streams.push_back (std::move (stream));
+        return *streams.back();
+    }
+
+    const int port;
+
+    juce::CriticalSection lock;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::atomic<int> numPackets { 0 };
+    std::atomic<bool> listening { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamReceiver)
+};
+
+// --- View ---
+// One tile per stream in a near-square grid, newest frame at each tile's right edge.
+class ViewerComponent : public juce::Component
+{
+public:
+    explicit ViewerComponent (int port)
+        : receiver (port)
+    {
+        setSize (1200, 800);
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (juce::Colours::black);
+
+        const juce::ScopedLock sl (receiver.getLock());
+        const auto& streams = receiver.getStreams();
+
+        if (streams.empty())
+        {
+            g.setColour (juce::Colours::grey);
+            g.setFont (14.0f);
+            g.drawText (receiver.isListening() ? "Waiting for broadcasts on port " + juce::String (receiver.getPort())
+                                               : "Could not listen on port " + juce::String (receiver.getPort()),
+                        getLocalBounds(), juce::Justification::centred);
+            return;
+        }
+
+        const int numStreams = (int) streams.size();
+        const int columns = (int) std::ceil (std::sqrt ((double) numStreams));
+        const int rows = (numStreams + columns - 1) / columns;
+        const auto now = juce::Time::getMillisecondCounter();
+
+        for (int i = 0; i < numStreams; ++i)
+        {
+            const auto& stream = *streams[(size_t) i];
+            const auto tile = juce::Rectangle<int> (getWidth() * (i % columns) / columns, getHeight() * (i / columns) / rows,
+                                                    getWidth() / columns, getHeight() / rows).reduced (2);
+
+            const bool online = now - stream.lastPacketMs < offlineAfterMs;
+            const auto colour = online ? juce::Colour::fromHSV ((float) i / (float) numStreams, 0.7f, 1.0f, 1.0f)
+                                       : juce::Colours::grey;
+
+            juce::Graphics::ScopedSaveState state (g);
+            g.reduceClipRegion (tile);
+            g.setOrigin (tile.getPosition());
+
+            g.setColour (juce::Colours::darkgrey.withAlpha (0.3f));
+            g.fillRect (tile.withZeroOrigin());
+
+            envelope.compute (stream.rms, stream.peak, 0, tile.getWidth(), zoomX);
+            envelope.paint (g, ScopeMapping { (float) tile.getHeight(), zoomY }, (float) tile.getWidth(), colour,
+                            1.5f, 0.6f, fillPath, peakPath);
+
+            g.setColour (colour);
+            g.setFont (13.0f);
+            g.drawText (stream.name + (online ? juce::String() : juce::String (" (offline)")),
+                        6, 4, tile.getWidth() - 12, 16, juce::Justification::topLeft);
+        }
+    }
+
+    void mouseWheelMove (const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override
+    {
+        const float factor = std::pow (1.15f, wheel.deltaY * 10.0f);
+
+        if (event.mods.isShiftDown()) zoomY = juce::jlimit (0.25f, 64.0f, zoomY * factor);
+        else                          zoomX = juce::jlimit (1.0f / 4096.0f, 8.0f, zoomX * factor);
+
+        repaint();
+    }
+
+private:
+    void onVBlank()
+    {
+        // Streams also go offline without any packet arriving, so look twice a second regardless
+        const int packets = receiver.getNumPackets();
+
+        if (packets != lastNumPackets || (++idleVBlanks % 30) == 0)
+        {
+            lastNumPackets = packets;
+            repaint();
+        }
+    }
+
+    StreamReceiver receiver;
+    ColumnEnvelope envelope;
+    juce::Path fillPath, peakPath;
+
+    float zoomX = 0.5f; // pixels per frame
+    float zoomY = 1.0f;
+
+    int lastNumPackets = -1;
+    int idleVBlanks = 0;
+    juce::VBlankAttachment vBlankAttachment { this, [this] { onVBlank(); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ViewerComponent)
+};
+
+// --- Application ---
+class SmoothScopeViewerApplication : public juce::JUCEApplication
+{
+public:
+    const juce::String getApplicationName() override { return "SmoothScopeViewer"; }
+    const juce::String getApplicationVersion() override { return "1.0.0"; }
+    bool moreThanOneInstanceAllowed() override { return true; }
+
+    void initialise (const juce::String& commandLine) override
+    {
+        const auto args = juce::StringArray::fromTokens (commandLine, true);
+        const int portIndex = args.indexOf ("--port");
+        const int port = portIndex >= 0 ? args[portIndex + 1].getIntValue() : LevelBroadcast::defaultPort;
+
+        mainWindow = std::make_unique<MainWindow> (getApplicationName(), port > 0 ? port : LevelBroadcast::defaultPort);
+    }
+
+    void shutdown() override { mainWindow = nullptr; }
+    void systemRequestedQuit() override { quit(); }
+
+private:
+    class MainWindow : public juce::DocumentWindow
+    {
+    public:
+        MainWindow (const juce::String& name, int port)
+            : DocumentWindow (name, juce::Colours::black, juce::DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar (true);
+            setContentOwned (new ViewerComponent (port), true);
+            setResizable (true, true);
+            centreWithSize (getWidth(), getHeight());
+            setVisible (true);
+        }
+
+        void closeButtonPressed() override
+        {
+            juce::JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
+    };
+
+    std::unique_ptr<MainWindow> mainWindow;
+};
+
+START_JUCE_APPLICATION (SmoothScopeViewerApplication)